@@ -19,6 +19,7 @@
 #include <memory>
 #include <variant> // for std::monostate if default edge prop used
 #include <utility>
+#include <cstdint>
 
 /*
  * Graph<T, Id, EdgeProp>
@@ -66,6 +67,7 @@ public:
             node_ptr n = std::make_shared<node_type>(id, value);
             nodes_.emplace(id, n);
             adj_.emplace(id, std::vector<Edge>{});
+            ++revision_;
         } else {
             it->second->set_value(value);
         }
@@ -74,6 +76,7 @@ public:
     void add_node(const node_ptr& n) {
         nodes_[n->id()] = n;
         adj_.emplace(n->id(), std::vector<Edge>{});
+        ++revision_;
     }
 
     void add_node(const id_type& id, value_type&& value) {
@@ -82,6 +85,7 @@ public:
             node_ptr n = std::make_shared<node_type>(id, std::move(value));
             nodes_.emplace(id, n);
             adj_.emplace(id, std::vector<Edge>{});
+            ++revision_;
         } else {
             it->second->set_value(std::move(value));
         }
@@ -101,6 +105,7 @@ public:
                       vec.end());
         }
         nodes_.erase(id);
+        ++revision_;
         return true;
     }
 
@@ -118,6 +123,7 @@ public:
         if (!directed_) {
             adj_[to].emplace_back(from, prop);
         }
+        ++revision_;
     }
 
     // Remove edge (for undirected graphs removes both directions)
@@ -127,6 +133,7 @@ public:
         if (!directed_) {
             removed = remove_edge_internal(to, from) || removed;
         }
+        if (removed) ++revision_;
         return removed;
     }
 
@@ -157,9 +164,14 @@ public:
 
     bool directed() const noexcept { return directed_; }
 
+    // Incremented by every change to the node or edge sets, so callers can tell
+    // whether a snapshot (CsrGraph, topological order, ...) is still current.
+    std::uint64_t revision() const noexcept { return revision_; }
+
     void clear() noexcept {
         nodes_.clear();
         adj_.clear();
+        ++revision_;
     }
 
     // ------------------------------------------------------------------
@@ -245,6 +257,7 @@ private:
     bool directed_;
     AdjacencyList adj_;
     std::unordered_map<id_type, node_ptr> nodes_;
+    std::uint64_t revision_ = 0;
 };
 
 #endif // GRAPH_HPP
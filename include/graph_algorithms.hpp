@@ -5,6 +5,7 @@
 #include <vector>
 #include <stack>
 #include <queue>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <optional>
@@ -14,6 +15,23 @@
 #include <type_traits>
 #include <stdexcept>
 #include <functional>
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <span>
+#include <memory>
+#include <iterator>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "thread_pool.hpp"
 
 
 // Free functions for algorithms that operate on a Graph-like type G.
@@ -82,8 +100,388 @@ std::vector<typename G::id_type> dfs(const G &g, const typename G::id_type &star
     return order;
 }
 
+// ---------- utility: "unreachable" distance for any arithmetic Weight ----------
+// numeric_limits<Weight>::infinity() is 0 for integral types, so integral
+// weights use max() as the unreachable marker instead.
+template <typename Weight>
+constexpr Weight weight_infinity() noexcept {
+    if constexpr (std::numeric_limits<Weight>::has_infinity) return std::numeric_limits<Weight>::infinity();
+    else return std::numeric_limits<Weight>::max();
+}
+
+// Mirror of weight_infinity() for max-sweeps (longest paths): -infinity when
+// the type has one, lowest() otherwise.
+template <typename Weight>
+constexpr Weight weight_negative_infinity() noexcept {
+    if constexpr (std::numeric_limits<Weight>::has_infinity) return -std::numeric_limits<Weight>::infinity();
+    else return std::numeric_limits<Weight>::lowest();
+}
+
+// ------------------ Dense snapshot (CSR) ------------------
+// CsrGraph: index-based copy of a graph's out-adjacency with the weights already
+// extracted. Node ids are mapped to 0..n-1 (ids[i] <-> index[id]) and the
+// out-edges of node i are targets/weights[offsets[i] .. offsets[i+1]).
+// Algorithms that run many relaxations build one of these once instead of
+// copying g.neighbors(u) and hashing ids on every step.
+template <typename Id, typename Weight>
+struct CsrGraph {
+    using id_type = Id;
+    using weight_type = Weight;
+
+    std::vector<id_type> ids;                        // index -> id
+    std::unordered_map<id_type, std::size_t> index;  // id -> index
+    std::vector<std::size_t> offsets;                // size node_count() + 1
+    std::vector<std::size_t> targets;                // edge -> head index
+    std::vector<weight_type> weights;                // edge -> weight
+
+    std::size_t node_count() const noexcept { return ids.size(); }
+    std::size_t edge_count() const noexcept { return targets.size(); }
+
+    // Same nodes (and index), every edge reversed: out-edges become in-edges.
+    CsrGraph transpose() const {
+        CsrGraph r;
+        r.ids = ids;
+        r.index = index;
+        const std::size_t n = node_count();
+        r.offsets.assign(n + 1, 0);
+        for (std::size_t v : targets) r.offsets[v + 1]++;
+        for (std::size_t i = 0; i < n; ++i) r.offsets[i + 1] += r.offsets[i];
+        r.targets.resize(edge_count());
+        r.weights.resize(edge_count());
+        std::vector<std::size_t> pos(r.offsets.begin(), r.offsets.end() - 1);
+        for (std::size_t u = 0; u < n; ++u) {
+            for (std::size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                std::size_t slot = pos[targets[e]]++;
+                r.targets[slot] = u;
+                r.weights[slot] = weights[e];
+            }
+        }
+        return r;
+    }
+};
+
+// make_csr_with_extractor: user provides Extractor(edge_property) -> numeric Weight
+template <typename Weight, typename G, typename Extractor>
+CsrGraph<typename G::id_type, Weight> make_csr_with_extractor(const G &g, Extractor extractor) {
+    static_assert(std::is_arithmetic<Weight>::value, "Weight must be arithmetic");
+
+    CsrGraph<typename G::id_type, Weight> csr;
+    auto nodes = g.list_nodes();
+    csr.ids.reserve(nodes.size());
+    csr.index.reserve(nodes.size());
+    for (const auto &p : nodes) {
+        csr.index.emplace(p.first, csr.ids.size());
+        csr.ids.push_back(p.first);
+    }
+
+    csr.offsets.assign(csr.ids.size() + 1, 0);
+    for (std::size_t i = 0; i < csr.ids.size(); ++i) {
+        for (const auto &e : g.neighbors(csr.ids[i])) {
+            csr.targets.push_back(csr.index.at(e.first));
+            csr.weights.push_back(static_cast<Weight>(extractor(e.second)));
+        }
+        csr.offsets[i + 1] = csr.targets.size();
+    }
+    return csr;
+}
+
+// Convenience wrapper that infers Weight from extractor return type
+template <typename G, typename Extractor>
+auto make_csr(const G &g, Extractor extractor) {
+    using Ret = std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>;
+    static_assert(std::is_arithmetic<Ret>::value, "Extractor must return arithmetic weight");
+    return make_csr_with_extractor<Ret>(g, extractor);
+}
+
+// Structure-only snapshot for algorithms that ignore weights (SCC, cycles,
+// levels, ...): every arc gets weight 1.
+template <typename G>
+auto make_csr_topology(const G &g) {
+    return make_csr_with_extractor<unsigned char>(g, [](const auto &) { return static_cast<unsigned char>(1); });
+}
+
+namespace detail {
+
+constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+// Converts index-based dist/prev arrays back to the id-keyed maps every
+// shortest-path function in this header returns.
+template <typename Id, typename Weight>
+std::pair<std::unordered_map<Id, Weight>, std::unordered_map<Id, std::optional<Id>>>
+to_maps(const CsrGraph<Id, Weight> &csr,
+        const std::vector<Weight> &dist,
+        const std::vector<std::size_t> &prev)
+{
+    std::unordered_map<Id, Weight> dist_map;
+    std::unordered_map<Id, std::optional<Id>> prev_map;
+    dist_map.reserve(csr.node_count());
+    prev_map.reserve(csr.node_count());
+    for (std::size_t i = 0; i < csr.node_count(); ++i) {
+        dist_map.emplace(csr.ids[i], dist[i]);
+        prev_map.emplace(csr.ids[i], prev[i] == npos ? std::nullopt : std::optional<Id>(csr.ids[prev[i]]));
+    }
+    return {std::move(dist_map), std::move(prev_map)};
+}
+
+// Calls step(v, out) for every v in frontier and returns what the calls
+// appended to out, concatenated per worker.
+template <typename Step>
+std::vector<std::size_t> expand_frontier(const std::vector<std::size_t> &frontier, ThreadPool &pool, Step step) {
+    std::vector<std::size_t> next;
+    if (pool.size() == 1 || frontier.size() < 1024) {
+        for (std::size_t v : frontier) step(v, next);
+        return next;
+    }
+    std::vector<std::vector<std::size_t>> local(pool.size());
+    pool.parallel_for(frontier.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        for (std::size_t i = begin; i < end; ++i) step(frontier[i], local[worker]);
+    });
+    for (auto &part : local) next.insert(next.end(), part.begin(), part.end());
+    return next;
+}
+
+} // namespace detail
+
+// ------------------ Dense shortest-path results ------------------
+// IdTable: the index <-> id mapping of a snapshot. Every ShortestPathTree
+// built from the same snapshot shares one table instead of copying it.
+template <typename Id>
+struct IdTable {
+    std::vector<Id> ids;                        // index -> id
+    std::unordered_map<Id, std::size_t> index;  // id -> index
+};
+
+// ShortestPathTree: dist/prev as flat arrays indexed like the snapshot, with
+// detail::npos as the "no predecessor" marker. Costs sizeof(Weight) +
+// sizeof(size_t) per node plus the shared IdTable, where the map pair costs two
+// hash nodes and a std::optional<Id> per node. Reads by id go through the
+// table (operator[], predecessor), reads by index are direct (distances(),
+// predecessors()), iteration yields (id, distance) in index order, and
+// path_to walks prev in O(path length).
+template <typename Id, typename Weight>
+class ShortestPathTree {
+public:
+    using id_type = Id;
+    using weight_type = Weight;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const Id &, const Weight &>;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() = default;
+        const_iterator(const ShortestPathTree *tree, std::size_t i) : tree_(tree), i_(i) {}
+
+        value_type operator*() const { return {tree_->table_->ids[i_], tree_->dist_[i_]}; }
+        const_iterator &operator++() { ++i_; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++i_; return old; }
+        bool operator==(const const_iterator &o) const { return i_ == o.i_; }
+
+    private:
+        const ShortestPathTree *tree_ = nullptr;
+        std::size_t i_ = 0;
+    };
+
+    ShortestPathTree() = default;
+    ShortestPathTree(std::shared_ptr<const IdTable<Id>> table, std::vector<Weight> dist,
+                     std::vector<std::size_t> prev, std::size_t source = detail::npos)
+        : table_(std::move(table)), dist_(std::move(dist)), prev_(std::move(prev)), source_(source) {}
+
+    std::size_t size() const noexcept { return dist_.size(); }
+    bool contains(const Id &id) const { return table_ && table_->index.count(id) != 0; }
+
+    // Throws std::out_of_range for ids the snapshot does not know, like map::at.
+    const Weight &operator[](const Id &id) const { return dist_[table_->index.at(id)]; }
+    const Weight &distance(const Id &id) const { return (*this)[id]; }
+
+    std::optional<Id> predecessor(const Id &id) const {
+        std::size_t p = prev_[table_->index.at(id)];
+        return p == detail::npos ? std::nullopt : std::optional<Id>(table_->ids[p]);
+    }
+
+    // source ... target; [source] for the source itself, empty when target was not reached.
+    std::vector<Id> path_to(const Id &target) const {
+        std::vector<Id> path;
+        std::size_t t = table_->index.at(target);
+        if (t != source_ && prev_[t] == detail::npos) return path;
+        for (std::size_t v = t; v != detail::npos; v = prev_[v]) path.push_back(table_->ids[v]);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+
+    const IdTable<Id> &ids() const { return *table_; }
+    std::span<const Weight> distances() const noexcept { return dist_; }
+    std::span<const std::size_t> predecessors() const noexcept { return prev_; }
+
+private:
+    std::shared_ptr<const IdTable<Id>> table_;
+    std::vector<Weight> dist_;
+    std::vector<std::size_t> prev_;
+    std::size_t source_ = detail::npos;
+};
+
+namespace detail {
+
+// id_table(csr) copies the snapshot's ids, id_table(std::move(csr)) steals them
+// (for wrappers whose snapshot dies right after the search).
+template <typename Id, typename Weight>
+std::shared_ptr<const IdTable<Id>> id_table(const CsrGraph<Id, Weight> &csr) {
+    return std::make_shared<const IdTable<Id>>(IdTable<Id>{csr.ids, csr.index});
+}
+
+template <typename Id, typename Weight>
+std::shared_ptr<const IdTable<Id>> id_table(CsrGraph<Id, Weight> &&csr) {
+    return std::make_shared<const IdTable<Id>>(IdTable<Id>{std::move(csr.ids), std::move(csr.index)});
+}
+
+} // namespace detail
+
+template <typename Id, typename Weight>
+std::vector<Id> reconstruct_path(const ShortestPathTree<Id, Weight> &tree, const Id &target) {
+    return tree.path_to(target);
+}
+
+// ------------------ Integer-weight SSSP (Dial / 0-1 BFS) ------------------
+// bounded_weight: tags an extractor with the largest weight it can return.
+// When the extractor returns an integral type and carries such a bound,
+// dijkstra() switches from the comparison heap to bucket queues.
+template <typename Extractor, typename Weight>
+struct BoundedExtractor {
+    Extractor extractor;
+    Weight max_weight;
+
+    template <typename EdgeProp>
+    Weight operator()(const EdgeProp &p) const { return static_cast<Weight>(extractor(p)); }
+};
+
+template <typename Weight, typename Extractor>
+BoundedExtractor<Extractor, Weight> bounded_weight(Extractor extractor, Weight max_weight) {
+    static_assert(std::is_integral<Weight>::value, "bounded_weight requires an integral Weight");
+    if (max_weight < Weight{0}) throw std::invalid_argument("max_weight must be non-negative");
+    return {std::move(extractor), max_weight};
+}
+
+template <typename Extractor, typename Weight>
+concept bounded_integral_extractor =
+    std::is_integral<Weight>::value && requires(const Extractor &e) {
+        { e.max_weight } -> std::convertible_to<Weight>;
+    };
+
+// Dial's algorithm: max_weight + 1 circular buckets indexed by dist % (max_weight + 1).
+// Every tentative distance lies in [current, current + max_weight], so the ring
+// never aliases two live distances. O(m + n * max_weight) time, O(n + max_weight) space.
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+dial_dense(const CsrGraph<Id, Weight> &csr, std::size_t start, Weight max_weight)
+{
+    static_assert(std::is_integral<Weight>::value, "Dial's algorithm requires integral weights");
+    const Weight INF = weight_infinity<Weight>();
+    const std::size_t n = csr.node_count();
+    const std::size_t ring = static_cast<std::size_t>(max_weight) + 1;
+
+    std::vector<Weight> dist(n, INF);
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::vector<char> settled(n, 0);
+    std::vector<std::vector<std::size_t>> buckets(ring);
+
+    dist[start] = Weight{0};
+    buckets[0].push_back(start);
+    std::size_t pending = 1;
+    Weight cur = Weight{0};
+
+    while (pending > 0) {
+        auto &bucket = buckets[static_cast<std::size_t>(cur) % ring];
+        if (bucket.empty()) { ++cur; continue; }
+        std::size_t u = bucket.back(); bucket.pop_back();
+        --pending;
+        if (settled[u] || dist[u] != cur) continue; // stale entry
+        settled[u] = 1;
+
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            Weight w = csr.weights[e];
+            if (w < Weight{0} || w > max_weight) {
+                throw std::out_of_range("edge weight outside [0, max_weight]");
+            }
+            std::size_t v = csr.targets[e];
+            if (cur + w < dist[v]) {
+                dist[v] = cur + w;
+                prev[v] = u;
+                buckets[static_cast<std::size_t>(dist[v]) % ring].push_back(v);
+                ++pending;
+            }
+        }
+    }
+    return {std::move(dist), std::move(prev)};
+}
+
+// 0-1 BFS: weight-0 edges go to the front of a deque, weight-1 edges to the back,
+// so the deque stays sorted by distance. O(n + m).
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+zero_one_bfs_dense(const CsrGraph<Id, Weight> &csr, std::size_t start)
+{
+    const Weight INF = weight_infinity<Weight>();
+    const std::size_t n = csr.node_count();
+
+    std::vector<Weight> dist(n, INF);
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::deque<std::size_t> dq;
+
+    dist[start] = Weight{0};
+    dq.push_back(start);
+
+    while (!dq.empty()) {
+        std::size_t u = dq.front(); dq.pop_front();
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            Weight w = csr.weights[e];
+            if (w != Weight{0} && w != Weight{1}) {
+                throw std::out_of_range("0-1 BFS requires edge weights in {0, 1}");
+            }
+            std::size_t v = csr.targets[e];
+            if (dist[u] + w < dist[v]) {
+                dist[v] = dist[u] + w;
+                prev[v] = u;
+                if (w == Weight{0}) dq.push_front(v);
+                else dq.push_back(v);
+            }
+        }
+    }
+    return {std::move(dist), std::move(prev)};
+}
+
+template <typename G, typename Weight, typename Extractor>
+std::pair<std::unordered_map<typename G::id_type, Weight>,
+          std::unordered_map<typename G::id_type, std::optional<typename G::id_type>>>
+dial_with_extractor(const G &g, const typename G::id_type &start, Extractor extractor, Weight max_weight)
+{
+    static_assert(std::is_integral<Weight>::value, "Dial's algorithm requires integral weights");
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    if (max_weight < Weight{0}) throw std::invalid_argument("max_weight must be non-negative");
+
+    auto csr = make_csr_with_extractor<Weight>(g, extractor);
+    auto [dist, prev] = dial_dense(csr, csr.index.at(start), max_weight);
+    return detail::to_maps(csr, dist, prev);
+}
+
+template <typename G, typename Extractor>
+auto zero_one_bfs(const G &g, const typename G::id_type &start, Extractor extractor) {
+    using Weight = std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>;
+    static_assert(std::is_arithmetic<Weight>::value, "Extractor must return arithmetic weight");
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+
+    auto csr = make_csr_with_extractor<Weight>(g, extractor);
+    auto [dist, prev] = zero_one_bfs_dense(csr, csr.index.at(start));
+    return detail::to_maps(csr, dist, prev);
+}
+
 // ------------------ Dijkstra (generic extractor) ------------------
 // dijkstra_with_extractor: user provides Extractor(edge_property) -> numeric Weight
+// If the extractor is a bounded_weight(...) with integral Weight, the search runs
+// as 0-1 BFS (max_weight <= 1) or Dial's bucket queue instead of a binary heap.
 template <typename G, typename Weight, typename Extractor>
 std::pair<std::unordered_map<typename G::id_type, Weight>,
           std::unordered_map<typename G::id_type, std::optional<typename G::id_type>>>
@@ -94,7 +492,17 @@ dijkstra_with_extractor(const G &g, const typename G::id_type &start, Extractor
 
     if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
 
-    const Weight INF = std::numeric_limits<Weight>::infinity();
+    if constexpr (bounded_integral_extractor<Extractor, Weight>) {
+        const Weight max_weight = static_cast<Weight>(extractor.max_weight);
+        if (max_weight <= Weight{1}) {
+            auto csr = make_csr_with_extractor<Weight>(g, extractor);
+            auto [d, p] = zero_one_bfs_dense(csr, csr.index.at(start));
+            return detail::to_maps(csr, d, p);
+        }
+        return dial_with_extractor<G, Weight>(g, start, extractor, max_weight);
+    }
+
+    const Weight INF = weight_infinity<Weight>();
     std::unordered_map<id_type, Weight> dist;
     std::unordered_map<id_type, std::optional<id_type>> prev;
 
@@ -141,6 +549,45 @@ auto dijkstra(const G &g, const typename G::id_type &start, Extractor extractor)
     return dijkstra_with_extractor<G, Ret, Extractor>(g, start, extractor);
 }
 
+// Same search on a prebuilt CsrGraph: index-based dist/prev (detail::npos = no predecessor).
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+dijkstra_dense(const CsrGraph<Id, Weight> &csr, std::size_t start)
+{
+    const Weight INF = weight_infinity<Weight>();
+    std::vector<Weight> dist(csr.node_count(), INF);
+    std::vector<std::size_t> prev(csr.node_count(), detail::npos);
+
+    using PQItem = std::pair<Weight, std::size_t>;
+    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+    dist[start] = Weight{0};
+    pq.push({Weight{0}, start});
+
+    while (!pq.empty()) {
+        auto [d, u] = pq.top(); pq.pop();
+        if (d > dist[u]) continue;
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            if (d + csr.weights[e] < dist[v]) {
+                dist[v] = d + csr.weights[e];
+                prev[v] = u;
+                pq.push({dist[v], v});
+            }
+        }
+    }
+    return {std::move(dist), std::move(prev)};
+}
+
+// dijkstra() with a ShortestPathTree result instead of the two maps.
+template <typename G, typename Extractor>
+auto dijkstra_tree(const G &g, const typename G::id_type &start, Extractor extractor) {
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    std::size_t s = csr.index.at(start);
+    auto [dist, prev] = dijkstra_dense(csr, s);
+    return ShortestPathTree(detail::id_table(std::move(csr)), std::move(dist), std::move(prev), s);
+}
+
 // ------------------ Reconstruct path ------------------
 template <typename G>
 std::vector<typename G::id_type>
@@ -164,253 +611,3270 @@ reconstruct_path(const std::unordered_map<typename G::id_type, std::optional<typ
     return path;
 }
 
-// ------------------ Topological sort (Kahn) ------------------
-template <typename G>
-std::vector<typename G::id_type> topological_sort(const G &g) {
-    using id_type = typename G::id_type;
-    if (!g.directed()) throw std::logic_error("Topological sort requires a directed graph");
-
-    std::unordered_map<id_type, int> indeg;
-    for (const auto &p : g.list_nodes()) indeg[p.first] = 0;
-    for (const auto &e : g.list_edges()) {
-        id_type to = std::get<1>(e);
-        indeg[to]++; 
-    }
+// ------------------ Point-to-point shortest path ------------------
+// PathResult: answer of a single s -> t query.
+//   distance : weight_infinity<Weight>() when t is unreachable
+//   path     : s ... t (just [s] when s == t), empty when unreachable
+//   settled  : vertices settled by the search (work done, useful for tuning)
+template <typename Id, typename Weight>
+struct PathResult {
+    Weight distance = weight_infinity<Weight>();
+    std::vector<Id> path;
+    std::size_t settled = 0;
 
-    std::queue<id_type> q;
-    for (const auto &kv : indeg) if (kv.second == 0) q.push(kv.first);
+    bool reachable() const noexcept { return distance != weight_infinity<Weight>(); }
+};
 
-    std::vector<id_type> order;
-    while (!q.empty()) {
-        id_type u = q.front(); q.pop();
-        order.push_back(u);
-        for (const auto &edge : g.neighbors(u)) {
-            id_type v = edge.first;
-            indeg[v]--;
-            if (indeg[v] == 0) q.push(v);
-        }
-    }
+namespace detail {
 
-    if (order.size() != indeg.size()) {
-        throw std::runtime_error("Graph has at least one cycle (topo sort failed)");
-    }
-    return order;
+// Follows index-based prev links from 'target' back to the root; returns ids root..target.
+template <typename Id>
+std::vector<Id> unwind_path(const std::vector<Id> &ids,
+                            const std::vector<std::size_t> &prev,
+                            std::size_t target)
+{
+    std::vector<Id> path;
+    for (std::size_t cur = target; cur != npos; cur = prev[cur]) path.push_back(ids[cur]);
+    std::reverse(path.begin(), path.end());
+    return path;
 }
 
-// ---------- utility: pair hash for unordered_map keys ----------
-template <typename A, typename B>
-struct PairHash {
-    std::size_t operator()(const std::pair<A,B>& p) const noexcept {
-        // combine two hashes (works for most std::hash<A/B> specializations)
-        std::size_t ha = std::hash<A>{}(p.first);
-        std::size_t hb = std::hash<B>{}(p.second);
-        // simple combination
-        return ha ^ (hb + 0x9e3779b97f4a7c15ULL + (ha<<6) + (ha>>2));
-    }
-};
+} // namespace detail
 
-// -----------------------------------------------------------------
-// Bipartite check (treats graph as undirected).
-//    If graph is directed(), we form an undirected view from list_edges().
-//    Returns true if graph is bipartite, false otherwise.
-// -----------------------------------------------------------------
-template <typename G>
-bool is_bipartite(const G &g) {
+// shortest_path: Dijkstra that stops as soon as 'target' is settled.
+// Works directly on g.neighbors() with lazily-filled maps, so only the
+// explored region is touched (no O(n) initialization).
+template <typename G, typename Extractor>
+auto shortest_path(const G &g,
+                   const typename G::id_type &source,
+                   const typename G::id_type &target,
+                   Extractor extractor)
+    -> PathResult<typename G::id_type, std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>>
+{
     using id_type = typename G::id_type;
+    using Weight = std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>;
+    static_assert(std::is_arithmetic<Weight>::value, "Extractor must return arithmetic weight");
 
-    // Build adjacency (undirected) view: unordered_map<id, vector<id>>
-    std::unordered_map<id_type, std::vector<id_type>> adj;
+    if (!g.has_node(source) || !g.has_node(target)) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
 
-    // initialize nodes (so isolated nodes appear)
-    for (const auto &p : g.list_nodes()) adj[p.first] = {};
+    PathResult<id_type, Weight> result;
+    std::unordered_map<id_type, Weight> dist;
+    std::unordered_map<id_type, id_type> prev;
 
-    // use list_edges to add both directions (works whether g is directed or not)
-    for (const auto &e : g.list_edges()) {
-        id_type u = std::get<0>(e);
-        id_type v = std::get<1>(e);
-        adj[u].push_back(v);
-        adj[v].push_back(u);
-    }
+    using PQItem = std::pair<Weight, id_type>;
+    auto cmp = [](const PQItem &a, const PQItem &b){ return a.first > b.first; };
+    std::priority_queue<PQItem, std::vector<PQItem>, decltype(cmp)> pq(cmp);
+    dist[source] = Weight{0};
+    pq.push({Weight{0}, source});
 
-    // color: -1 = uncolored, 0/1 = two colors
-    std::unordered_map<id_type, int> color;
-    color.reserve(adj.size());
-    for (const auto &kv : adj) color[kv.first] = -1;
+    while (!pq.empty()) {
+        auto [d, u] = pq.top(); pq.pop();
+        if (d > dist[u]) continue;
+        ++result.settled;
 
-    std::queue<id_type> q;
+        if (u == target) {
+            result.distance = d;
+            for (id_type cur = target; ; cur = prev[cur]) {
+                result.path.push_back(cur);
+                if (cur == source) break;
+            }
+            std::reverse(result.path.begin(), result.path.end());
+            return result;
+        }
 
-    for (const auto &kv : adj) {
-        id_type start = kv.first;
-        if (color[start] != -1) continue;
-
-        // start BFS coloring
-        color[start] = 0;
-        q.push(start);
-
-        while (!q.empty()) {
-            id_type u = q.front(); q.pop();
-            for (auto v : adj[u]) {
-                if (color[v] == -1) {
-                    color[v] = color[u] ^ 1;
-                    q.push(v);
-                } else if (color[v] == color[u]) {
-                    // same color on adjacent vertices -> not bipartite
-                    return false;
-                }
+        for (const auto &e : g.neighbors(u)) {
+            id_type v = e.first;
+            Weight w = static_cast<Weight>(extractor(e.second));
+            auto it = dist.find(v);
+            if (it == dist.end() || d + w < it->second) {
+                dist[v] = d + w;
+                prev[v] = u;
+                pq.push({d + w, v});
             }
         }
     }
-
-    return true;
+    return result; // unreachable
 }
 
-// -----------------------------------------------------------------
-// Acyclic check
-//    - For directed graphs: uses DFS color method to detect back-edges.
-//    - For undirected graphs: uses DFS and parent check (detects cycles).
-// -----------------------------------------------------------------
-template <typename G>
-bool is_acyclic(const G &g) {
-    using id_type = typename G::id_type;
+// Same query on a prebuilt CsrGraph (reuse the snapshot across many queries).
+template <typename Id, typename Weight>
+PathResult<Id, Weight> shortest_path(const CsrGraph<Id, Weight> &csr, const Id &source, const Id &target) {
+    auto sit = csr.index.find(source);
+    auto tit = csr.index.find(target);
+    if (sit == csr.index.end() || tit == csr.index.end()) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
+    const std::size_t s = sit->second, t = tit->second;
+    const Weight INF = weight_infinity<Weight>();
 
-    // Use nodes list for initialization
-    std::vector<id_type> nodes;
-    nodes.reserve(g.list_nodes().size());
-    for (const auto &p : g.list_nodes()) nodes.push_back(p.first);
-
-    if (g.directed()) {
-        // Directed cycle detection (colors: 0=white,1=gray,2=black)
-        std::unordered_map<id_type, int> color;
-        for (auto id : nodes) color[id] = 0;
-
-        std::function<bool(const id_type&)> dfs_visit;
-        dfs_visit = [&](const id_type &u) -> bool {
-            color[u] = 1; // gray
-            for (const auto &edge : g.neighbors(u)) {
-                id_type v = edge.first;
-                if (color[v] == 0) {
-                    if (!dfs_visit(v)) return false;
-                } else if (color[v] == 1) {
-                    // back-edge found -> cycle
-                    return false;
-                }
-            }
-            color[u] = 2; // black
-            return true;
-        };
+    PathResult<Id, Weight> result;
+    std::vector<Weight> dist(csr.node_count(), INF);
+    std::vector<std::size_t> prev(csr.node_count(), detail::npos);
 
-        for (auto id : nodes) {
-            if (color[id] == 0) {
-                if (!dfs_visit(id)) return false;
-            }
-        }
-        return true;
-    } else {
-        // Undirected cycle detection using DFS with parent tracking
-        std::unordered_map<id_type, bool> visited;
-        for (auto id : nodes) visited[id] = false;
-
-        std::function<bool(const id_type&, const id_type&)> dfs_undirected;
-        dfs_undirected = [&](const id_type &u, const id_type &parent) -> bool {
-            visited[u] = true;
-            for (const auto &edge : g.neighbors(u)) {
-                id_type v = edge.first;
-                if (!visited[v]) {
-                    if (!dfs_undirected(v, u)) return false;
-                } else if (v != parent) {
-                    // visited neighbor that's not parent -> cycle
-                    return false;
-                }
-            }
-            return true;
-        };
+    using PQItem = std::pair<Weight, std::size_t>;
+    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+    dist[s] = Weight{0};
+    pq.push({Weight{0}, s});
 
-        for (auto id : nodes) {
-            if (!visited[id]) {
-                if (!dfs_undirected(id, id)) return false;
+    while (!pq.empty()) {
+        auto [d, u] = pq.top(); pq.pop();
+        if (d > dist[u]) continue;
+        ++result.settled;
+        if (u == t) {
+            result.distance = d;
+            result.path = detail::unwind_path(csr.ids, prev, t);
+            return result;
+        }
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            if (d + csr.weights[e] < dist[v]) {
+                dist[v] = d + csr.weights[e];
+                prev[v] = u;
+                pq.push({dist[v], v});
             }
         }
-        return true;
     }
+    return result;
 }
 
-// -----------------------------------------------------------------
-// Kosaraju's algorithm for Strongly Connected Components (SCCs)
-//    Works for directed graphs. For undirected graphs it will return
-//    connected components (each SCC will equal a connected component).
-//    Returns vector<vector<id_type>> where each inner vector is one component.
-// -----------------------------------------------------------------
-template <typename G>
-std::vector<std::vector<typename G::id_type>> kosaraju_scc(const G &g) {
-    using id_type = typename G::id_type;
-
-    // 1) Build adjacency lists (directed)
-    std::unordered_map<id_type, std::vector<id_type>> adj;
-    std::unordered_map<id_type, std::vector<id_type>> rev_adj;
+// ------------------ Bidirectional Dijkstra ------------------
+// Forward search on 'fwd' from s, backward search on 'bwd' (= fwd.transpose(),
+// i.e. in-edges) from t, always advancing the side whose queue minimum is smaller.
+// mu tracks the best s-t distance through any vertex labelled by both sides;
+// the search stops once top_forward + top_backward >= mu.
+template <typename Id, typename Weight>
+PathResult<Id, Weight> bidirectional_dijkstra(const CsrGraph<Id, Weight> &fwd,
+                                              const CsrGraph<Id, Weight> &bwd,
+                                              const Id &source, const Id &target)
+{
+    auto sit = fwd.index.find(source);
+    auto tit = fwd.index.find(target);
+    if (sit == fwd.index.end() || tit == fwd.index.end()) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
+    if (fwd.node_count() != bwd.node_count()) {
+        throw std::invalid_argument("backward graph must be the transpose of the forward graph");
+    }
+    const std::size_t s = sit->second, t = tit->second;
+    const std::size_t n = fwd.node_count();
+    const Weight INF = weight_infinity<Weight>();
 
-    for (const auto &p : g.list_nodes()) {
-        adj[p.first] = {};
-        rev_adj[p.first] = {};
+    PathResult<Id, Weight> result;
+    if (s == t) {
+        result.distance = Weight{0};
+        result.path = {source};
+        return result;
     }
 
-    for (const auto &e : g.list_edges()) {
-        id_type u = std::get<0>(e);
-        id_type v = std::get<1>(e);
-        adj[u].push_back(v);
-        rev_adj[v].push_back(u);
-        // if graph is undirected, list_edges likely includes both directions or we should add reverse:
-        if (!g.directed()) {
-            rev_adj[u].push_back(v);
-            adj[v].push_back(u);
+    using PQItem = std::pair<Weight, std::size_t>;
+    using PQ = std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>>;
+    std::vector<Weight> dist[2] = {std::vector<Weight>(n, INF), std::vector<Weight>(n, INF)};
+    std::vector<std::size_t> prev[2] = {std::vector<std::size_t>(n, detail::npos),
+                                        std::vector<std::size_t>(n, detail::npos)};
+    PQ pq[2];
+    const CsrGraph<Id, Weight> *side_graph[2] = {&fwd, &bwd};
+
+    dist[0][s] = Weight{0}; pq[0].push({Weight{0}, s});
+    dist[1][t] = Weight{0}; pq[1].push({Weight{0}, t});
+
+    Weight mu = INF;
+    std::size_t meet = detail::npos;
+
+    while (!pq[0].empty() && !pq[1].empty()) {
+        if (mu != INF && pq[0].top().first + pq[1].top().first >= mu) break;
+
+        const int side = pq[0].top().first <= pq[1].top().first ? 0 : 1;
+        auto [d, u] = pq[side].top(); pq[side].pop();
+        if (d > dist[side][u]) continue;
+        ++result.settled;
+
+        const auto &csr = *side_graph[side];
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            Weight nd = d + csr.weights[e];
+            if (nd < dist[side][v]) {
+                dist[side][v] = nd;
+                prev[side][v] = u;
+                pq[side].push({nd, v});
+                if (dist[1 - side][v] != INF && nd + dist[1 - side][v] < mu) {
+                    mu = nd + dist[1 - side][v];
+                    meet = v;
+                }
+            }
+        }
+    }
+
+    if (meet == detail::npos) return result;
+
+    result.distance = mu;
+    result.path = detail::unwind_path(fwd.ids, prev[0], meet);       // s .. meet
+    for (std::size_t cur = prev[1][meet]; cur != detail::npos; cur = prev[1][cur]) {
+        result.path.push_back(fwd.ids[cur]);                         // .. t
+    }
+    return result;
+}
+
+// Graph wrapper: snapshots g once (and its transpose when directed).
+// For repeated queries build the CsrGraph pair yourself and call the overload above.
+template <typename G, typename Extractor>
+auto bidirectional_dijkstra(const G &g,
+                            const typename G::id_type &source,
+                            const typename G::id_type &target,
+                            Extractor extractor)
+{
+    if (!g.has_node(source) || !g.has_node(target)) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
+    auto fwd = make_csr(g, extractor);
+    if (!g.directed()) return bidirectional_dijkstra(fwd, fwd, source, target);
+    auto bwd = fwd.transpose();
+    return bidirectional_dijkstra(fwd, bwd, source, target);
+}
+
+// ------------------ A* (goal-directed search) ------------------
+// astar: user provides Extractor(edge_property) -> Weight and
+// Heuristic(id) -> Weight, a lower bound on dist(id, target).
+// With an admissible heuristic the returned distance is exact (nodes are
+// reopened if a shorter path shows up); with a consistent one no node is
+// settled twice. heuristic == 0 degenerates to shortest_path().
+template <typename G, typename Extractor, typename Heuristic>
+auto astar(const G &g,
+           const typename G::id_type &source,
+           const typename G::id_type &target,
+           Extractor extractor,
+           Heuristic heuristic)
+    -> PathResult<typename G::id_type, std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>>
+{
+    using id_type = typename G::id_type;
+    using Weight = std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>;
+    static_assert(std::is_arithmetic<Weight>::value, "Extractor must return arithmetic weight");
+
+    if (!g.has_node(source) || !g.has_node(target)) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
+
+    PathResult<id_type, Weight> result;
+    std::unordered_map<id_type, Weight> dist;
+    std::unordered_map<id_type, id_type> prev;
+
+    // (f = g + h, g, node)
+    using PQItem = std::tuple<Weight, Weight, id_type>;
+    auto cmp = [](const PQItem &a, const PQItem &b){ return std::get<0>(a) > std::get<0>(b); };
+    std::priority_queue<PQItem, std::vector<PQItem>, decltype(cmp)> pq(cmp);
+    dist[source] = Weight{0};
+    pq.push({static_cast<Weight>(heuristic(source)), Weight{0}, source});
+
+    while (!pq.empty()) {
+        auto [f, d, u] = pq.top(); pq.pop();
+        if (d > dist[u]) continue;
+        ++result.settled;
+
+        if (u == target) {
+            result.distance = d;
+            for (id_type cur = target; ; cur = prev[cur]) {
+                result.path.push_back(cur);
+                if (cur == source) break;
+            }
+            std::reverse(result.path.begin(), result.path.end());
+            return result;
+        }
+
+        for (const auto &e : g.neighbors(u)) {
+            id_type v = e.first;
+            Weight nd = d + static_cast<Weight>(extractor(e.second));
+            auto it = dist.find(v);
+            if (it == dist.end() || nd < it->second) {
+                dist[v] = nd;
+                prev[v] = u;
+                pq.push({nd + static_cast<Weight>(heuristic(v)), nd, v});
+            }
+        }
+    }
+    return result; // unreachable
+}
+
+// Same query on a prebuilt CsrGraph; heuristic is still called with node ids.
+template <typename Id, typename Weight, typename Heuristic>
+PathResult<Id, Weight> astar(const CsrGraph<Id, Weight> &csr,
+                             const Id &source, const Id &target,
+                             Heuristic heuristic)
+{
+    auto sit = csr.index.find(source);
+    auto tit = csr.index.find(target);
+    if (sit == csr.index.end() || tit == csr.index.end()) {
+        throw std::invalid_argument("source or target node doesn't exist");
+    }
+    const std::size_t s = sit->second, t = tit->second;
+
+    PathResult<Id, Weight> result;
+    std::vector<Weight> dist(csr.node_count(), weight_infinity<Weight>());
+    std::vector<std::size_t> prev(csr.node_count(), detail::npos);
+
+    using PQItem = std::tuple<Weight, Weight, std::size_t>;
+    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+    dist[s] = Weight{0};
+    pq.push({static_cast<Weight>(heuristic(source)), Weight{0}, s});
+
+    while (!pq.empty()) {
+        auto [f, d, u] = pq.top(); pq.pop();
+        if (d > dist[u]) continue;
+        ++result.settled;
+        if (u == t) {
+            result.distance = d;
+            result.path = detail::unwind_path(csr.ids, prev, t);
+            return result;
+        }
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            Weight nd = d + csr.weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                prev[v] = u;
+                pq.push({nd + static_cast<Weight>(heuristic(csr.ids[v])), nd, v});
+            }
+        }
+    }
+    return result;
+}
+
+// ------------------ ALT heuristic (A*, Landmarks, Triangle inequality) ------------------
+// Precomputes, for a few landmark nodes L, d(L, v) (forward search) and
+// d(v, L) (search on the transpose). By the triangle inequality
+//     d(v, t) >= d(L, t) - d(L, v)   and   d(v, t) >= d(v, L) - d(t, L)
+// so the max over landmarks is an admissible (and consistent) lower bound.
+// Landmarks are chosen by farthest-point selection: each new landmark is the
+// node farthest (by min forward distance) from the ones already picked.
+// Memory: 2 * landmarks * n weights.
+template <typename Id, typename Weight>
+class AltHeuristic {
+public:
+    AltHeuristic(const CsrGraph<Id, Weight> &fwd, const CsrGraph<Id, Weight> &bwd, std::size_t landmark_count)
+        : index_(fwd.index), n_(fwd.node_count())
+    {
+        if (fwd.node_count() != bwd.node_count()) {
+            throw std::invalid_argument("backward graph must be the transpose of the forward graph");
+        }
+        landmark_count = std::min(landmark_count, n_);
+        const Weight INF = weight_infinity<Weight>();
+
+        // closeness[v] = min over picked landmarks of d(L, v); unreachable counts as farthest
+        std::vector<Weight> closeness(n_, INF);
+        std::size_t next = 0;
+        for (std::size_t k = 0; k < landmark_count; ++k) {
+            landmarks_.push_back(fwd.ids[next]);
+            auto from = dijkstra_dense(fwd, next).first;
+            auto to = dijkstra_dense(bwd, next).first;
+            from_.insert(from_.end(), from.begin(), from.end());
+            to_.insert(to_.end(), to.begin(), to.end());
+
+            for (std::size_t v = 0; v < n_; ++v) closeness[v] = std::min(closeness[v], from[v]);
+            std::size_t best = next;
+            for (std::size_t v = 0; v < n_; ++v) {
+                if (closeness[v] != Weight{0} && (best == next || closeness[v] > closeness[best])) best = v;
+            }
+            if (best == next) break; // every node is a landmark already
+            next = best;
+        }
+    }
+
+    const std::vector<Id> &landmarks() const noexcept { return landmarks_; }
+
+    // Lower bound on dist(v, target); 0 when no landmark gives information.
+    Weight lower_bound(const Id &v, const Id &target) const {
+        const std::size_t vi = index_.at(v), ti = index_.at(target);
+        const Weight INF = weight_infinity<Weight>();
+        Weight best = Weight{0};
+        for (std::size_t l = 0; l < landmarks_.size(); ++l) {
+            const Weight *from = &from_[l * n_];
+            const Weight *to = &to_[l * n_];
+            if (from[vi] != INF && from[ti] != INF && from[ti] - from[vi] > best) best = from[ti] - from[vi];
+            if (to[vi] != INF && to[ti] != INF && to[vi] - to[ti] > best) best = to[vi] - to[ti];
+        }
+        return best;
+    }
+
+    // Heuristic callable for astar(): h(v) = lower_bound(v, target)
+    auto to(const Id &target) const {
+        return [this, target](const Id &v) { return lower_bound(v, target); };
+    }
+
+private:
+    std::unordered_map<Id, std::size_t> index_;
+    std::size_t n_;
+    std::vector<Id> landmarks_;
+    std::vector<Weight> from_; // landmark-major: from_[l * n + v] = d(L_l, v)
+    std::vector<Weight> to_;   // landmark-major: to_[l * n + v]   = d(v, L_l)
+};
+
+template <typename G, typename Extractor>
+auto make_alt_heuristic(const G &g, Extractor extractor, std::size_t landmark_count = 8) {
+    auto fwd = make_csr(g, extractor);
+    using Weight = typename decltype(fwd)::weight_type;
+    if (!g.directed()) return AltHeuristic<typename G::id_type, Weight>(fwd, fwd, landmark_count);
+    return AltHeuristic<typename G::id_type, Weight>(fwd, fwd.transpose(), landmark_count);
+}
+
+// ------------------ Contraction hierarchies ------------------
+// Offline: nodes are contracted one by one in order of a lazily re-evaluated
+// priority (edge difference + contracted neighbors + depth). Contracting v
+// removes it from the remaining graph; for every in-neighbor u and out-neighbor
+// w a shortcut u -> w (weight d(u,v) + d(v,w)) is added unless a bounded local
+// Dijkstra from u that avoids v (the witness search) finds a path no longer.
+// Each node's contraction position is its rank.
+//
+// Online: s -> t is a bidirectional Dijkstra that only climbs ranks (forward on
+// "up" arcs from s, backward on "down" arcs into t) with stall-on-demand.
+// Shortcuts remember the two arcs they replace, so the result is unpacked
+// back to original edges.
+//
+// The hierarchy is index-based (ids/index as in CsrGraph) and can be written
+// to / read from a binary stream with save() / load().
+template <typename Id, typename Weight>
+class ChQuery;
+
+template <typename Id, typename Weight>
+class ContractionHierarchy {
+public:
+    using id_type = Id;
+    using weight_type = Weight;
+
+    // Original edges have no children (detail::npos); a shortcut's children are
+    // the arcs (from -> middle) and (middle -> to) it replaces.
+    struct Arc {
+        std::size_t from;
+        std::size_t to;
+        Weight weight;
+        std::size_t child_first;
+        std::size_t child_second;
+
+        bool is_shortcut() const noexcept { return child_first != detail::npos; }
+    };
+
+    ContractionHierarchy() = default;
+
+    // witness_settle_limit bounds each witness search; a smaller limit builds
+    // faster but may add shortcuts that are not strictly needed (never wrong ones).
+    static ContractionHierarchy build(const CsrGraph<Id, Weight> &csr, std::size_t witness_settle_limit = 500) {
+        ContractionHierarchy ch;
+        ch.ids_ = csr.ids;
+        ch.index_ = csr.index;
+        ch.contract(csr, witness_settle_limit);
+        ch.finalize();
+        return ch;
+    }
+
+    std::size_t node_count() const noexcept { return ids_.size(); }
+    std::size_t arc_count() const noexcept { return arcs_.size(); }
+    std::size_t shortcut_count() const noexcept {
+        return static_cast<std::size_t>(std::count_if(arcs_.begin(), arcs_.end(),
+                                                      [](const Arc &a){ return a.is_shortcut(); }));
+    }
+    std::size_t rank(const Id &id) const { return rank_[index_.at(id)]; }
+    const std::vector<Arc> &arcs() const noexcept { return arcs_; }
+    const std::vector<Id> &ids() const noexcept { return ids_; }
+    const std::unordered_map<Id, std::size_t> &index() const noexcept { return index_; }
+
+    // Query-side adjacency entry: the higher-ranked endpoint, the weight and the arc id.
+    struct HalfArc {
+        std::size_t node;
+        Weight weight;
+        std::size_t arc;
+    };
+
+    // Arcs from node index u to higher-ranked nodes (u -> node), and arcs into u
+    // from higher-ranked nodes (node -> u); the two halves of every upward search.
+    std::span<const HalfArc> upward(std::size_t u) const noexcept {
+        return {up_.data() + up_offsets_[u], up_offsets_[u + 1] - up_offsets_[u]};
+    }
+    std::span<const HalfArc> downward(std::size_t u) const noexcept {
+        return {down_.data() + down_offsets_[u], down_offsets_[u + 1] - down_offsets_[u]};
+    }
+
+    // One-off query; allocates O(n) scratch. Keep a ChQuery around for repeated queries.
+    PathResult<Id, Weight> query(const Id &source, const Id &target) const;
+
+    // Binary format: magic, sizeof(Id), sizeof(Weight), n, arc count, ids, ranks, arcs.
+    void save(std::ostream &out) const {
+        static_assert(std::is_trivially_copyable<Id>::value, "save() requires a trivially copyable Id");
+        out.write(kMagic, sizeof(kMagic));
+        write_u64(out, sizeof(Id));
+        write_u64(out, sizeof(Weight));
+        write_u64(out, ids_.size());
+        write_u64(out, arcs_.size());
+        out.write(reinterpret_cast<const char *>(ids_.data()), static_cast<std::streamsize>(ids_.size() * sizeof(Id)));
+        for (std::size_t r : rank_) write_u64(out, r);
+        for (const Arc &a : arcs_) {
+            write_u64(out, a.from);
+            write_u64(out, a.to);
+            out.write(reinterpret_cast<const char *>(&a.weight), sizeof(Weight));
+            write_u64(out, a.child_first);
+            write_u64(out, a.child_second);
+        }
+        if (!out) throw std::runtime_error("failed to write contraction hierarchy");
+    }
+
+    static ContractionHierarchy load(std::istream &in) {
+        static_assert(std::is_trivially_copyable<Id>::value, "load() requires a trivially copyable Id");
+        char magic[sizeof(kMagic)];
+        in.read(magic, sizeof(magic));
+        if (!in || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+            throw std::runtime_error("not a contraction hierarchy stream");
+        }
+        if (read_u64(in) != sizeof(Id) || read_u64(in) != sizeof(Weight)) {
+            throw std::runtime_error("contraction hierarchy was saved with different Id/Weight types");
+        }
+        ContractionHierarchy ch;
+        std::size_t n = read_u64(in), m = read_u64(in);
+        ch.ids_.resize(n);
+        in.read(reinterpret_cast<char *>(ch.ids_.data()), static_cast<std::streamsize>(n * sizeof(Id)));
+        ch.rank_.resize(n);
+        for (auto &r : ch.rank_) r = read_u64(in);
+        ch.arcs_.resize(m);
+        for (Arc &a : ch.arcs_) {
+            a.from = read_u64(in);
+            a.to = read_u64(in);
+            in.read(reinterpret_cast<char *>(&a.weight), sizeof(Weight));
+            a.child_first = read_u64(in);
+            a.child_second = read_u64(in);
+            if (a.from >= n || a.to >= n) throw std::runtime_error("corrupt contraction hierarchy arc");
+        }
+        if (!in) throw std::runtime_error("truncated contraction hierarchy stream");
+        ch.index_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) ch.index_.emplace(ch.ids_[i], i);
+        ch.finalize();
+        return ch;
+    }
+
+private:
+    friend class ChQuery<Id, Weight>;
+    static constexpr char kMagic[8] = {'P', 'A', 'A', 'C', 'H', '0', '0', '1'};
+
+    static void write_u64(std::ostream &out, std::uint64_t v) { out.write(reinterpret_cast<const char *>(&v), sizeof(v)); }
+    static std::uint64_t read_u64(std::istream &in) {
+        std::uint64_t v = 0;
+        in.read(reinterpret_cast<char *>(&v), sizeof(v));
+        return v;
+    }
+
+    // Remaining-graph adjacency during contraction: (neighbor, arc id)
+    using DynAdj = std::vector<std::vector<std::pair<std::size_t, std::size_t>>>;
+
+    void contract(const CsrGraph<Id, Weight> &csr, std::size_t settle_limit) {
+        const std::size_t n = csr.node_count();
+        const Weight INF = weight_infinity<Weight>();
+        DynAdj out(n), in(n);
+
+        // original edges: drop self loops, keep the lightest of parallel edges
+        std::vector<std::size_t> seen(n, detail::npos);
+        for (std::size_t u = 0; u < n; ++u) {
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                std::size_t v = csr.targets[e];
+                Weight w = csr.weights[e];
+                if (w < Weight{0}) throw std::invalid_argument("contraction hierarchies require non-negative weights");
+                if (v == u || w == INF) continue;
+                if (seen[v] != detail::npos && arcs_[seen[v]].from == u) {
+                    arcs_[seen[v]].weight = std::min(arcs_[seen[v]].weight, w);
+                    continue;
+                }
+                seen[v] = arcs_.size();
+                out[u].push_back({v, arcs_.size()});
+                in[v].push_back({u, arcs_.size()});
+                arcs_.push_back({u, v, w, detail::npos, detail::npos});
+            }
+        }
+
+        // witness-search scratch, reset via the touched list
+        std::vector<Weight> dist(n, INF);
+        std::vector<std::size_t> touched;
+        std::vector<char> contracted(n, 0);
+        std::vector<std::size_t> deleted_neighbors(n, 0);
+        // target_mark[x] == stamp while x is an out-neighbor of the node being examined
+        std::vector<std::size_t> target_mark(n, 0);
+        std::size_t stamp = 0;
+
+        using PQItem = std::pair<Weight, std::size_t>;
+        std::vector<PQItem> heap; // reused binary heap (std::push_heap / std::pop_heap)
+        // stops once every out-neighbor of 'avoid' is settled, the bound is passed
+        // or settle_limit nodes were settled
+        auto witness = [&](std::size_t from, std::size_t avoid, Weight bound, std::size_t targets) {
+            for (std::size_t x : touched) dist[x] = INF;
+            touched.clear();
+            heap.assign(1, {Weight{0}, from});
+            dist[from] = Weight{0};
+            touched.push_back(from);
+            std::size_t settled = 0;
+            while (!heap.empty() && settled < settle_limit && targets > 0) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<PQItem>{});
+                auto [d, x] = heap.back(); heap.pop_back();
+                if (d > dist[x]) continue;
+                if (d > bound) break;
+                ++settled;
+                if (target_mark[x] == stamp) --targets;
+                for (const auto &[y, a] : out[x]) {
+                    if (y == avoid) continue;
+                    Weight nd = d + arcs_[a].weight;
+                    if (nd < dist[y]) {
+                        if (dist[y] == INF) touched.push_back(y);
+                        dist[y] = nd;
+                        heap.push_back({nd, y});
+                        std::push_heap(heap.begin(), heap.end(), std::greater<PQItem>{});
+                    }
+                }
+            }
+        };
+
+        // Calls on_shortcut(u, a_in, w, a_out, weight) for every shortcut contracting v needs.
+        auto for_each_shortcut = [&](std::size_t v, auto &&on_shortcut) {
+            if (out[v].empty()) return;
+            Weight max_out = Weight{0};
+            ++stamp;
+            for (const auto &[w, a] : out[v]) {
+                max_out = std::max(max_out, arcs_[a].weight);
+                target_mark[w] = stamp;
+            }
+            for (const auto &[u, a_in] : in[v]) {
+                witness(u, v, arcs_[a_in].weight + max_out, out[v].size());
+                for (const auto &[w, a_out] : out[v]) {
+                    if (w == u) continue;
+                    Weight via = arcs_[a_in].weight + arcs_[a_out].weight;
+                    if (dist[w] > via) on_shortcut(u, a_in, w, a_out, via);
+                }
+            }
+        };
+
+        // edge difference + contracted neighbors + hierarchy depth
+        std::vector<std::size_t> level(n, 0);
+        auto priority = [&](std::size_t v) -> long long {
+            long long shortcuts = 0;
+            for_each_shortcut(v, [&](std::size_t, std::size_t, std::size_t, std::size_t, Weight) { ++shortcuts; });
+            long long removed = static_cast<long long>(in[v].size() + out[v].size());
+            return 2 * (shortcuts - removed) + static_cast<long long>(deleted_neighbors[v] + level[v]);
+        };
+
+        // entries whose key differs from current[v] are stale
+        using OrderItem = std::pair<long long, std::size_t>;
+        std::priority_queue<OrderItem, std::vector<OrderItem>, std::greater<OrderItem>> order;
+        std::vector<long long> current(n);
+        for (std::size_t v = 0; v < n; ++v) {
+            current[v] = priority(v);
+            order.push({current[v], v});
+        }
+
+        rank_.assign(n, 0);
+        std::size_t next_rank = 0;
+        std::vector<std::tuple<std::size_t, std::size_t, std::size_t, std::size_t, Weight>> pending;
+
+        while (!order.empty()) {
+            auto [key, v] = order.top(); order.pop();
+            if (contracted[v] || key != current[v]) continue;
+
+            // lazy update: re-evaluate and defer if v is no longer the minimum
+            long long p = priority(v);
+            if (p != key) {
+                current[v] = p;
+                if (!order.empty() && p > order.top().first) {
+                    order.push({p, v});
+                    continue;
+                }
+            }
+
+            pending.clear();
+            for_each_shortcut(v, [&](std::size_t u, std::size_t a_in, std::size_t w, std::size_t a_out, Weight via) {
+                pending.emplace_back(u, a_in, w, a_out, via);
+            });
+            for (const auto &[u, a_in, w, a_out, via] : pending) {
+                std::size_t id = arcs_.size();
+                arcs_.push_back({u, w, via, a_in, a_out});
+                auto it = std::find_if(out[u].begin(), out[u].end(), [&](const auto &p){ return p.first == w; });
+                if (it == out[u].end()) {
+                    out[u].push_back({w, id});
+                    in[w].push_back({u, id});
+                } else if (via < arcs_[it->second].weight) {
+                    it->second = id;
+                    for (auto &q : in[w]) if (q.first == u) q.second = id;
+                }
+            }
+
+            // detach v from the remaining graph
+            std::vector<std::size_t> neighbors;
+            for (const auto &[u, a] : in[v]) {
+                auto &vec = out[u];
+                vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const auto &q){ return q.first == v; }), vec.end());
+                neighbors.push_back(u);
+            }
+            for (const auto &[w, a] : out[v]) {
+                auto &vec = in[w];
+                vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const auto &q){ return q.first == v; }), vec.end());
+                neighbors.push_back(w);
+            }
+            in[v].clear(); in[v].shrink_to_fit();
+            out[v].clear(); out[v].shrink_to_fit();
+
+            contracted[v] = 1;
+            rank_[v] = next_rank++;
+
+            // neighbors' priorities changed: re-key them
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+            for (std::size_t x : neighbors) {
+                ++deleted_neighbors[x];
+                level[x] = std::max(level[x], level[v] + 1);
+                current[x] = priority(x);
+                order.push({current[x], x});
+            }
+        }
+    }
+
+    // Splits arcs by rank into two CSR arrays keyed by the lower-ranked endpoint:
+    // up_ holds low -> high arcs (forward search), down_ holds high -> low arcs
+    // (backward search). Weights are copied next to the head so a scan does not
+    // touch arcs_.
+    void finalize() {
+        const std::size_t n = ids_.size();
+        up_offsets_.assign(n + 1, 0);
+        down_offsets_.assign(n + 1, 0);
+        for (const Arc &a : arcs_) {
+            if (rank_[a.from] < rank_[a.to]) up_offsets_[a.from + 1]++;
+            else down_offsets_[a.to + 1]++;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            up_offsets_[i + 1] += up_offsets_[i];
+            down_offsets_[i + 1] += down_offsets_[i];
+        }
+        up_.resize(up_offsets_[n]);
+        down_.resize(down_offsets_[n]);
+        std::vector<std::size_t> up_pos(up_offsets_.begin(), up_offsets_.end() - 1);
+        std::vector<std::size_t> down_pos(down_offsets_.begin(), down_offsets_.end() - 1);
+        for (std::size_t a = 0; a < arcs_.size(); ++a) {
+            const Arc &arc = arcs_[a];
+            if (rank_[arc.from] < rank_[arc.to]) up_[up_pos[arc.from]++] = {arc.to, arc.weight, a};
+            else down_[down_pos[arc.to]++] = {arc.from, arc.weight, a};
+        }
+    }
+
+    // Appends the original-edge node sequence of 'arc', excluding arc.from.
+    void unpack(std::size_t arc, std::vector<Id> &path) const {
+        std::vector<std::size_t> st{arc};
+        while (!st.empty()) {
+            const Arc &a = arcs_[st.back()]; st.pop_back();
+            if (!a.is_shortcut()) {
+                path.push_back(ids_[a.to]);
+            } else {
+                st.push_back(a.child_second);
+                st.push_back(a.child_first);
+            }
+        }
+    }
+
+    std::vector<Id> ids_;
+    std::unordered_map<Id, std::size_t> index_;
+    std::vector<std::size_t> rank_;
+    std::vector<Arc> arcs_;
+    std::vector<std::size_t> up_offsets_, down_offsets_;
+    std::vector<HalfArc> up_, down_;
+};
+
+// ChQuery: reusable query state for one ContractionHierarchy. Scratch arrays are
+// allocated once and reset through a touched list, so a query costs
+// O(search space) rather than O(n). Not thread-safe: use one ChQuery per thread.
+template <typename Id, typename Weight>
+class ChQuery {
+public:
+    explicit ChQuery(const ContractionHierarchy<Id, Weight> &ch)
+        : ch_(ch)
+    {
+        const std::size_t n = ch.node_count();
+        for (int side = 0; side < 2; ++side) {
+            dist_[side].assign(n, weight_infinity<Weight>());
+            via_arc_[side].assign(n, detail::npos);
+        }
+    }
+
+    PathResult<Id, Weight> run(const Id &source, const Id &target) {
+        auto sit = ch_.index_.find(source);
+        auto tit = ch_.index_.find(target);
+        if (sit == ch_.index_.end() || tit == ch_.index_.end()) {
+            throw std::invalid_argument("source or target node doesn't exist");
+        }
+        const Weight INF = weight_infinity<Weight>();
+        reset();
+
+        using PQItem = std::pair<Weight, std::size_t>;
+        using PQ = std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>>;
+        PQ pq[2];
+        const std::size_t start[2] = {sit->second, tit->second};
+        for (int side = 0; side < 2; ++side) {
+            dist_[side][start[side]] = Weight{0};
+            touched_.push_back(start[side]);
+            pq[side].push({Weight{0}, start[side]});
+        }
+
+        PathResult<Id, Weight> result;
+        Weight mu = INF;
+        std::size_t meet = detail::npos;
+
+        // each side may stop once its queue minimum reaches mu
+        auto active = [&](int side) { return !pq[side].empty() && pq[side].top().first < mu; };
+        while (active(0) || active(1)) {
+            int side = !active(1) ? 0 : !active(0) ? 1 : (pq[0].top().first <= pq[1].top().first ? 0 : 1);
+            auto [d, u] = pq[side].top(); pq[side].pop();
+            if (d > dist_[side][u]) continue;
+            ++result.settled;
+
+            if (dist_[1 - side][u] != INF && d + dist_[1 - side][u] < mu) {
+                mu = d + dist_[1 - side][u];
+                meet = u;
+            }
+
+            const auto &offsets = side == 0 ? ch_.up_offsets_ : ch_.down_offsets_;
+            const auto &arcs = side == 0 ? ch_.up_ : ch_.down_;
+
+            // stall-on-demand: a higher node already reaches u more cheaply,
+            // so u's label is not final and expanding it is wasted work
+            const auto &opp_offsets = side == 0 ? ch_.down_offsets_ : ch_.up_offsets_;
+            const auto &opp_arcs = side == 0 ? ch_.down_ : ch_.up_;
+            bool stalled = false;
+            for (std::size_t i = opp_offsets[u]; i < opp_offsets[u + 1] && !stalled; ++i) {
+                const auto &h = opp_arcs[i];
+                stalled = dist_[side][h.node] != INF && dist_[side][h.node] + h.weight < d;
+            }
+            if (stalled) continue;
+
+            for (std::size_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                const auto &h = arcs[i];
+                Weight nd = d + h.weight;
+                if (nd < dist_[side][h.node]) {
+                    if (dist_[0][h.node] == INF && dist_[1][h.node] == INF) touched_.push_back(h.node);
+                    dist_[side][h.node] = nd;
+                    via_arc_[side][h.node] = h.arc;
+                    pq[side].push({nd, h.node});
+                }
+            }
+        }
+
+        if (meet == detail::npos) return result;
+        result.distance = mu;
+
+        // s .. meet: collect forward arcs backwards, then unpack in order
+        std::vector<std::size_t> chain;
+        for (std::size_t x = meet; via_arc_[0][x] != detail::npos; x = ch_.arcs_[via_arc_[0][x]].from) {
+            chain.push_back(via_arc_[0][x]);
+        }
+        result.path.push_back(source);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) ch_.unpack(*it, result.path);
+        // meet .. t
+        for (std::size_t x = meet; via_arc_[1][x] != detail::npos; x = ch_.arcs_[via_arc_[1][x]].to) {
+            ch_.unpack(via_arc_[1][x], result.path);
+        }
+        return result;
+    }
+
+private:
+    void reset() {
+        for (std::size_t x : touched_) {
+            for (int side = 0; side < 2; ++side) {
+                dist_[side][x] = weight_infinity<Weight>();
+                via_arc_[side][x] = detail::npos;
+            }
+        }
+        touched_.clear();
+    }
+
+    const ContractionHierarchy<Id, Weight> &ch_;
+    std::vector<Weight> dist_[2];
+    std::vector<std::size_t> via_arc_[2];
+    std::vector<std::size_t> touched_;
+};
+
+template <typename Id, typename Weight>
+PathResult<Id, Weight> ContractionHierarchy<Id, Weight>::query(const Id &source, const Id &target) const {
+    ChQuery<Id, Weight> q(*this);
+    return q.run(source, target);
+}
+
+template <typename G, typename Extractor>
+auto build_contraction_hierarchy(const G &g, Extractor extractor, std::size_t witness_settle_limit = 500) {
+    auto csr = make_csr(g, extractor);
+    using Weight = typename decltype(csr)::weight_type;
+    return ContractionHierarchy<typename G::id_type, Weight>::build(csr, witness_settle_limit);
+}
+
+// ------------------ Delta-stepping (parallel SSSP) ------------------
+// Tentative distances are grouped in buckets of width delta. The lowest
+// non-empty bucket is emptied in phases: its nodes relax their light edges
+// (w <= delta) in parallel, re-filling the same bucket, until it stays empty;
+// then all nodes removed from it relax their heavy edges (w > delta) once.
+// Distances are lowered with an atomic compare-and-swap min, so relaxations
+// from different threads never lose an improvement.
+//
+// prev is derived after the distances are final (BFS over tight edges
+// dist[u] + w == dist[v] from the start), so it is always a valid shortest-path
+// tree; it equals dijkstra()'s prev whenever shortest paths are unique.
+//
+// suggest_delta: max_weight / average out-degree (Meyer & Sanders), i.e. about
+// one light edge per node; larger delta = fewer phases but more re-relaxations.
+template <typename Id, typename Weight>
+Weight suggest_delta(const CsrGraph<Id, Weight> &csr) {
+    const Weight INF = weight_infinity<Weight>();
+    Weight max_w = Weight{0};
+    for (Weight w : csr.weights) if (w != INF) max_w = std::max(max_w, w);
+    if (csr.node_count() == 0 || csr.edge_count() == 0 || max_w == Weight{0}) return Weight{1};
+    double avg_degree = static_cast<double>(csr.edge_count()) / static_cast<double>(csr.node_count());
+    Weight delta = static_cast<Weight>(static_cast<double>(max_w) / std::max(1.0, avg_degree));
+    return delta > Weight{0} ? delta : Weight{1};
+}
+
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+delta_stepping_dense(const CsrGraph<Id, Weight> &csr, std::size_t start, ThreadPool &pool, Weight delta = Weight{0})
+{
+    const Weight INF = weight_infinity<Weight>();
+    const std::size_t n = csr.node_count();
+    if (delta <= Weight{0}) delta = suggest_delta(csr);
+
+    Weight max_w = Weight{0};
+    for (Weight w : csr.weights) {
+        if (w < Weight{0}) throw std::invalid_argument("delta-stepping requires non-negative weights");
+        if (w != INF) max_w = std::max(max_w, w);
+    }
+
+    // every live distance lies within max_w of the current bucket, so a ring
+    // of max_w / delta + 2 buckets never aliases
+    const std::size_t ring = static_cast<std::size_t>(max_w / delta) + 2;
+    auto bucket_of = [&](Weight d) { return static_cast<std::size_t>(d / delta); };
+
+    std::vector<std::atomic<Weight>> dist(n);
+    for (auto &d : dist) d.store(INF, std::memory_order_relaxed);
+    dist[start].store(Weight{0}, std::memory_order_relaxed);
+
+    auto relax = [&](std::size_t v, Weight nd) {
+        Weight cur = dist[v].load(std::memory_order_relaxed);
+        while (nd < cur) {
+            if (dist[v].compare_exchange_weak(cur, nd, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    };
+
+    std::vector<std::vector<std::size_t>> buckets(ring);
+    std::vector<std::vector<std::size_t>> inserts(pool.size());
+    std::size_t pending = 1;
+    buckets[0].push_back(start);
+
+    // moves per-worker relaxation results into their (current) buckets
+    auto flush = [&]() {
+        for (auto &local : inserts) {
+            for (std::size_t v : local) {
+                buckets[bucket_of(dist[v].load(std::memory_order_relaxed)) % ring].push_back(v);
+                ++pending;
+            }
+            local.clear();
+        }
+    };
+
+    auto relax_edges = [&](const std::vector<std::size_t> &nodes, bool light) {
+        pool.parallel_for(nodes.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+            auto &local = inserts[worker];
+            for (std::size_t i = begin; i < end; ++i) {
+                std::size_t u = nodes[i];
+                Weight du = dist[u].load(std::memory_order_relaxed);
+                for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                    Weight w = csr.weights[e];
+                    if (w == INF || (w <= delta) != light) continue;
+                    if (relax(csr.targets[e], du + w)) local.push_back(csr.targets[e]);
+                }
+            }
+        });
+        flush();
+    };
+
+    // phase_mark dedups a bucket's entries per phase, removed_mark per bucket
+    std::vector<std::size_t> phase_mark(n, detail::npos), removed_mark(n, detail::npos);
+    std::vector<std::size_t> frontier, removed;
+    std::size_t phase = 0;
+    for (std::size_t current = 0; pending > 0; ++current) {
+        auto &bucket = buckets[current % ring];
+        if (bucket.empty()) continue;
+
+        removed.clear();
+        while (!bucket.empty()) {
+            frontier.clear();
+            ++phase;
+            for (std::size_t v : bucket) {
+                --pending;
+                // stale entry (moved to a lower bucket) or duplicate
+                if (bucket_of(dist[v].load(std::memory_order_relaxed)) != current) continue;
+                if (phase_mark[v] == phase) continue;
+                phase_mark[v] = phase;
+                frontier.push_back(v);
+                if (removed_mark[v] != current) {
+                    removed_mark[v] = current;
+                    removed.push_back(v);
+                }
+            }
+            bucket.clear();
+            relax_edges(frontier, true);
+        }
+        relax_edges(removed, false);
+    }
+
+    std::vector<Weight> final_dist(n);
+    for (std::size_t v = 0; v < n; ++v) final_dist[v] = dist[v].load(std::memory_order_relaxed);
+
+    // predecessor tree over tight edges
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::vector<char> reached(n, 0);
+    std::queue<std::size_t> q;
+    reached[start] = 1;
+    q.push(start);
+    while (!q.empty()) {
+        std::size_t u = q.front(); q.pop();
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            if (!reached[v] && csr.weights[e] != INF && final_dist[u] + csr.weights[e] == final_dist[v]) {
+                reached[v] = 1;
+                prev[v] = u;
+                q.push(v);
+            }
+        }
+    }
+    return {std::move(final_dist), std::move(prev)};
+}
+
+// Graph wrapper: same result maps as dijkstra(). threads == 0 -> hardware_concurrency(),
+// delta == 0 -> suggest_delta().
+template <typename G, typename Extractor>
+auto delta_stepping(const G &g,
+                    const typename G::id_type &start,
+                    Extractor extractor,
+                    std::size_t threads = 0,
+                    std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))> delta = {})
+{
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    auto [dist, prev] = delta_stepping_dense(csr, csr.index.at(start), pool, delta);
+    return detail::to_maps(csr, dist, prev);
+}
+
+// ------------------ Reusable SSSP workspaces ------------------
+// For high query rates: a workspace is bound to one CsrGraph and keeps its
+// dense arrays, heap/queue storage and the list of reached nodes between runs.
+// Entries are valid only if stamp[v] == epoch; starting a new run just bumps
+// the epoch, so no O(n) re-initialization happens after construction and each
+// run costs O(nodes touched + edges scanned). One workspace per thread.
+namespace detail {
+
+// Epoch-stamped dist/prev arrays shared by the workspaces below.
+template <typename Weight>
+class StampedLabels {
+public:
+    explicit StampedLabels(std::size_t n)
+        : dist_(n), prev_(n, npos), stamp_(n, 0) {}
+
+    void reset() { ++epoch_; touched_.clear(); }
+
+    bool reached(std::size_t v) const noexcept { return stamp_[v] == epoch_; }
+    Weight dist(std::size_t v) const noexcept { return reached(v) ? dist_[v] : weight_infinity<Weight>(); }
+    std::size_t prev(std::size_t v) const noexcept { return reached(v) ? prev_[v] : npos; }
+
+    void set(std::size_t v, Weight d, std::size_t p) {
+        if (!reached(v)) { stamp_[v] = epoch_; touched_.push_back(v); }
+        dist_[v] = d;
+        prev_[v] = p;
+    }
+
+    const std::vector<std::size_t> &touched() const noexcept { return touched_; }
+
+private:
+    std::vector<Weight> dist_;
+    std::vector<std::size_t> prev_;
+    std::vector<std::size_t> stamp_;
+    std::vector<std::size_t> touched_;
+    std::size_t epoch_ = 1;
+};
+
+} // namespace detail
+
+// Shared accessors: everything is reported for the most recent run().
+template <typename Id, typename Weight>
+class WorkspaceBase {
+public:
+    explicit WorkspaceBase(const CsrGraph<Id, Weight> &csr) : csr_(csr), labels_(csr.node_count()) {}
+
+    Weight distance(const Id &v) const { return labels_.dist(csr_.index.at(v)); }
+    bool reached(const Id &v) const { return labels_.reached(csr_.index.at(v)); }
+
+    std::optional<Id> predecessor(const Id &v) const {
+        std::size_t p = labels_.prev(csr_.index.at(v));
+        return p == detail::npos ? std::nullopt : std::optional<Id>(csr_.ids[p]);
+    }
+
+    // source .. v, empty if v was not reached
+    std::vector<Id> path_to(const Id &v) const {
+        std::size_t vi = csr_.index.at(v);
+        if (!labels_.reached(vi)) return {};
+        std::vector<Id> path;
+        for (std::size_t cur = vi; cur != detail::npos; cur = labels_.prev(cur)) path.push_back(csr_.ids[cur]);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Node indexes (into csr.ids) reached by the last run, in discovery order.
+    const std::vector<std::size_t> &touched() const noexcept { return labels_.touched(); }
+    const CsrGraph<Id, Weight> &graph() const noexcept { return csr_; }
+
+protected:
+    std::size_t index_of(const Id &v) const {
+        auto it = csr_.index.find(v);
+        if (it == csr_.index.end()) throw std::invalid_argument("node doesn't exist");
+        return it->second;
+    }
+
+    const CsrGraph<Id, Weight> &csr_;
+    detail::StampedLabels<Weight> labels_;
+};
+
+template <typename Id, typename Weight>
+class DijkstraWorkspace : public WorkspaceBase<Id, Weight> {
+    using Base = WorkspaceBase<Id, Weight>;
+public:
+    using Base::Base;
+
+    // Full single-source run; query results with distance()/path_to().
+    void run(const Id &source) {
+        run_until(this->index_of(source), [](std::size_t, Weight) { return false; });
+    }
+
+    // Point-to-point run that stops once target is settled. Afterwards only
+    // settled nodes have final distances; the rest hold tentative upper bounds.
+    PathResult<Id, Weight> run(const Id &source, const Id &target) {
+        PathResult<Id, Weight> result;
+        const std::size_t t = this->index_of(target);
+        result.settled = run_until(this->index_of(source), [t](std::size_t u, Weight) { return u == t; });
+        if (this->labels_.reached(t)) {
+            result.distance = this->labels_.dist(t);
+            result.path = this->path_to(target);
+        }
+        return result;
+    }
+
+    // Index-level run: on_settle(node_index, dist) is called for every settled
+    // node in distance order; returning true stops the search.
+    // Returns the number of settled nodes.
+    template <typename OnSettle>
+    std::size_t run_until(std::size_t s, OnSettle on_settle) {
+        const auto &csr = this->csr_;
+        auto &labels = this->labels_;
+        labels.reset();
+        heap_.clear();
+        labels.set(s, Weight{0}, detail::npos);
+        heap_.push_back({Weight{0}, s});
+
+        std::size_t settled = 0;
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<PQItem>{});
+            auto [d, u] = heap_.back(); heap_.pop_back();
+            if (d > labels.dist(u)) continue;
+            ++settled;
+            if (on_settle(u, d)) break;
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                std::size_t v = csr.targets[e];
+                Weight nd = d + csr.weights[e];
+                if (nd < labels.dist(v)) {
+                    labels.set(v, nd, u);
+                    heap_.push_back({nd, v});
+                    std::push_heap(heap_.begin(), heap_.end(), std::greater<PQItem>{});
+                }
+            }
+        }
+        return settled;
+    }
+
+private:
+
+    using PQItem = std::pair<Weight, std::size_t>;
+    std::vector<PQItem> heap_;
+};
+
+// Unweighted hop distances (edge weights ignored); order() is the BFS visit order.
+template <typename Id, typename Weight>
+class BfsWorkspace : public WorkspaceBase<Id, Weight> {
+    using Base = WorkspaceBase<Id, Weight>;
+public:
+    using Base::Base;
+
+    // Returns ids in visit order (same order as graph_algo::bfs on the snapshot).
+    std::vector<Id> run(const Id &source) {
+        const auto &csr = this->csr_;
+        auto &labels = this->labels_;
+        labels.reset();
+        std::size_t s = this->index_of(source);
+        labels.set(s, Weight{0}, detail::npos);
+
+        // touched() doubles as the FIFO queue: nodes are appended in discovery order
+        for (std::size_t head = 0; head < labels.touched().size(); ++head) {
+            std::size_t u = labels.touched()[head];
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                std::size_t v = csr.targets[e];
+                if (!labels.reached(v)) labels.set(v, labels.dist(u) + Weight{1}, u);
+            }
+        }
+
+        std::vector<Id> order;
+        order.reserve(labels.touched().size());
+        for (std::size_t v : labels.touched()) order.push_back(csr.ids[v]);
+        return order;
+    }
+};
+
+// Bellman-Ford that only scans out-edges of nodes reached so far.
+// run() returns true if a negative cycle is reachable from the source.
+template <typename Id, typename Weight>
+class BellmanFordWorkspace : public WorkspaceBase<Id, Weight> {
+    using Base = WorkspaceBase<Id, Weight>;
+public:
+    using Base::Base;
+
+    bool run(const Id &source) {
+        const auto &csr = this->csr_;
+        auto &labels = this->labels_;
+        labels.reset();
+        labels.set(this->index_of(source), Weight{0}, detail::npos);
+
+        auto relax_all = [&]() {
+            bool updated = false;
+            // touched() can grow while iterating; index-based loop picks new nodes up
+            for (std::size_t i = 0; i < labels.touched().size(); ++i) {
+                std::size_t u = labels.touched()[i];
+                Weight du = labels.dist(u);
+                for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                    std::size_t v = csr.targets[e];
+                    if (csr.weights[e] == weight_infinity<Weight>()) continue;
+                    if (du + csr.weights[e] < labels.dist(v)) {
+                        labels.set(v, du + csr.weights[e], u);
+                        updated = true;
+                    }
+                }
+            }
+            return updated;
+        };
+
+        const std::size_t n = csr.node_count();
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            if (!relax_all()) return false;
+        }
+        return relax_all();
+    }
+};
+
+// ------------------ Many-to-many distance tables ------------------
+// Row-major |sources| x |targets| matrix: at(i, j) = dist(sources[i], targets[j]),
+// weight_infinity<Weight>() when unreachable.
+template <typename Id, typename Weight>
+struct DistanceTable {
+    std::vector<Id> sources;
+    std::vector<Id> targets;
+    std::vector<Weight> values;
+
+    Weight at(std::size_t i, std::size_t j) const { return values[i * targets.size() + j]; }
+    std::span<const Weight> row(std::size_t i) const {
+        return {values.data() + i * targets.size(), targets.size()};
+    }
+};
+
+namespace detail {
+
+// Node index -> the table columns it fills (a target may be listed twice).
+struct ColumnIndex {
+    std::vector<std::size_t> offsets;  // size n + 1
+    std::vector<std::size_t> columns;
+    std::size_t distinct = 0;          // number of distinct target nodes
+
+    template <typename Id>
+    ColumnIndex(const std::unordered_map<Id, std::size_t> &index, std::size_t n, const std::vector<Id> &targets)
+        : offsets(n + 1, 0), columns(targets.size())
+    {
+        std::vector<std::size_t> node_of(targets.size());
+        for (std::size_t j = 0; j < targets.size(); ++j) {
+            auto it = index.find(targets[j]);
+            if (it == index.end()) throw std::invalid_argument("target node doesn't exist");
+            node_of[j] = it->second;
+            if (offsets[it->second + 1]++ == 0) ++distinct;
+        }
+        for (std::size_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+        std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+        for (std::size_t j = 0; j < targets.size(); ++j) columns[pos[node_of[j]]++] = j;
+    }
+
+    std::span<const std::size_t> of(std::size_t u) const {
+        return {columns.data() + offsets[u], offsets[u + 1] - offsets[u]};
+    }
+};
+
+template <typename Id>
+std::vector<std::size_t> indexes_of(const std::unordered_map<Id, std::size_t> &index, const std::vector<Id> &ids) {
+    std::vector<std::size_t> out(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        auto it = index.find(ids[i]);
+        if (it == index.end()) throw std::invalid_argument("source node doesn't exist");
+        out[i] = it->second;
+    }
+    return out;
+}
+
+} // namespace detail
+
+// One early-stopping Dijkstra per source: a search ends as soon as every
+// distinct target is settled, so tight target sets cost far less than full
+// SSSP. Sources are split across the pool; each worker owns a DijkstraWorkspace
+// and writes only its own rows.
+template <typename Id, typename Weight>
+DistanceTable<Id, Weight> distance_table(const CsrGraph<Id, Weight> &csr,
+                                         const std::vector<Id> &sources,
+                                         const std::vector<Id> &targets,
+                                         ThreadPool &pool)
+{
+    DistanceTable<Id, Weight> table{sources, targets, {}};
+    table.values.assign(sources.size() * targets.size(), weight_infinity<Weight>());
+    if (sources.empty() || targets.empty()) return table;
+
+    const auto src = detail::indexes_of(csr.index, sources);
+    const detail::ColumnIndex cols(csr.index, csr.node_count(), targets);
+
+    std::vector<std::optional<DijkstraWorkspace<Id, Weight>>> ws(pool.size());
+    pool.parallel_for(src.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        if (!ws[worker]) ws[worker].emplace(csr);
+        for (std::size_t i = begin; i < end; ++i) {
+            Weight *row = table.values.data() + i * targets.size();
+            std::size_t remaining = cols.distinct;
+            ws[worker]->run_until(src[i], [&](std::size_t u, Weight d) {
+                auto hit = cols.of(u);
+                if (hit.empty()) return false;
+                for (std::size_t j : hit) row[j] = d;
+                return --remaining == 0;
+            });
+        }
+    }, 1);
+    return table;
+}
+
+// Graph wrapper. threads == 0 -> hardware_concurrency().
+template <typename G, typename Extractor>
+auto distance_table(const G &g,
+                    const std::vector<typename G::id_type> &sources,
+                    const std::vector<typename G::id_type> &targets,
+                    Extractor extractor,
+                    std::size_t threads = 0)
+{
+    auto csr = make_csr(g, extractor);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    return distance_table(csr, sources, targets, pool);
+}
+
+namespace detail {
+
+// Upward Dijkstra in a contraction hierarchy with stall-on-demand.
+// forward == true follows upward() arcs (distances from start), otherwise
+// downward() arcs (distances to start). visit(node, dist) sees every
+// settled, non-stalled node. dist must be all-infinity on entry and is
+// restored through 'touched' before returning.
+template <typename Id, typename Weight, typename Visit>
+void ch_upward_search(const ContractionHierarchy<Id, Weight> &ch, std::size_t start, bool forward,
+                      std::vector<Weight> &dist, std::vector<std::size_t> &touched,
+                      std::vector<std::pair<Weight, std::size_t>> &heap, Visit visit)
+{
+    using PQItem = std::pair<Weight, std::size_t>;
+    const Weight INF = weight_infinity<Weight>();
+    heap.clear();
+    touched.clear();
+    dist[start] = Weight{0};
+    touched.push_back(start);
+    heap.push_back({Weight{0}, start});
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<PQItem>{});
+        auto [d, u] = heap.back(); heap.pop_back();
+        if (d > dist[u]) continue;
+
+        bool stalled = false;
+        for (const auto &h : forward ? ch.downward(u) : ch.upward(u)) {
+            if (dist[h.node] != INF && dist[h.node] + h.weight < d) { stalled = true; break; }
+        }
+        if (stalled) continue;
+        visit(u, d);
+
+        for (const auto &h : forward ? ch.upward(u) : ch.downward(u)) {
+            Weight nd = d + h.weight;
+            if (nd < dist[h.node]) {
+                if (dist[h.node] == INF) touched.push_back(h.node);
+                dist[h.node] = nd;
+                heap.push_back({nd, h.node});
+                std::push_heap(heap.begin(), heap.end(), std::greater<PQItem>{});
+            }
+        }
+    }
+    for (std::size_t x : touched) dist[x] = INF;
+}
+
+} // namespace detail
+
+// Bucket-based many-to-many on a contraction hierarchy: one backward upward
+// search per target leaves (column, dist-to-target) entries in a bucket at every
+// node it settles; one forward upward search per source then scans the buckets
+// of the nodes it settles. Every shortest path meets at its highest node, so
+// the minimum over buckets is exact. Both phases run on the pool; search
+// spaces are small, so this beats per-source Dijkstra by orders of magnitude
+// once the hierarchy is built.
+template <typename Id, typename Weight>
+DistanceTable<Id, Weight> distance_table(const ContractionHierarchy<Id, Weight> &ch,
+                                         const std::vector<Id> &sources,
+                                         const std::vector<Id> &targets,
+                                         ThreadPool &pool)
+{
+    DistanceTable<Id, Weight> table{sources, targets, {}};
+    table.values.assign(sources.size() * targets.size(), weight_infinity<Weight>());
+    if (sources.empty() || targets.empty()) return table;
+
+    const std::size_t n = ch.node_count();
+    const auto src = detail::indexes_of(ch.index(), sources);
+    const auto tgt = detail::indexes_of(ch.index(), targets);
+
+    struct Scratch {
+        std::vector<Weight> dist;
+        std::vector<std::size_t> touched;
+        std::vector<std::pair<Weight, std::size_t>> heap;
+    };
+    std::vector<Scratch> scratch(pool.size());
+    auto ready = [&](std::size_t worker) -> Scratch & {
+        Scratch &s = scratch[worker];
+        if (s.dist.size() != n) s.dist.assign(n, weight_infinity<Weight>());
+        return s;
+    };
+
+    // backward phase: per-worker (node, column, dist) entries
+    struct Entry { std::size_t node; std::size_t column; Weight dist; };
+    std::vector<std::vector<Entry>> entries(pool.size());
+    pool.parallel_for(tgt.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        Scratch &s = ready(worker);
+        for (std::size_t j = begin; j < end; ++j) {
+            detail::ch_upward_search(ch, tgt[j], false, s.dist, s.touched, s.heap, [&](std::size_t u, Weight d) {
+                entries[worker].push_back({u, j, d});
+            });
+        }
+    }, 1);
+
+    // buckets as CSR keyed by node
+    std::vector<std::size_t> offsets(n + 1, 0);
+    for (const auto &part : entries) for (const Entry &e : part) offsets[e.node + 1]++;
+    for (std::size_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+    std::vector<std::pair<std::size_t, Weight>> buckets(offsets[n]);
+    {
+        std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+        for (auto &part : entries) {
+            for (const Entry &e : part) buckets[pos[e.node]++] = {e.column, e.dist};
+            std::vector<Entry>().swap(part);
+        }
+    }
+
+    // forward phase
+    pool.parallel_for(src.size(), [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        Scratch &s = ready(worker);
+        for (std::size_t i = begin; i < end; ++i) {
+            Weight *row = table.values.data() + i * targets.size();
+            detail::ch_upward_search(ch, src[i], true, s.dist, s.touched, s.heap, [&](std::size_t u, Weight d) {
+                for (std::size_t b = offsets[u]; b < offsets[u + 1]; ++b) {
+                    auto [j, dt] = buckets[b];
+                    if (d + dt < row[j]) row[j] = d + dt;
+                }
+            });
+        }
+    }, 1);
+    return table;
+}
+
+// ------------------ Batched point-to-point queries ------------------
+// BatchQueryEngine: collects (source, target) queries and answers them in one
+// pass. Identical queries are answered once, queries are grouped by source,
+// each group is one Dijkstra that stops when its last distinct target is
+// settled, and groups run concurrently on the pool. Results come back in
+// submission order. Same scheme as beecrowd/algorithms/bee2130_disjktra2.cpp.
+//
+//   BatchQueryEngine<int, double> engine(csr, pool);
+//   auto a = engine.submit(1, 7);
+//   auto b = engine.submit(1, 9);
+//   auto results = engine.run();   // results[a], results[b]
+template <typename Id, typename Weight>
+class BatchQueryEngine {
+public:
+    BatchQueryEngine(const CsrGraph<Id, Weight> &csr, ThreadPool &pool)
+        : csr_(csr), pool_(pool), mark_(pool.size()), workspaces_(pool.size()) {}
+
+    // Queues a query and returns its position in the next run()'s results.
+    std::size_t submit(const Id &source, const Id &target) {
+        auto sit = csr_.index.find(source);
+        auto tit = csr_.index.find(target);
+        if (sit == csr_.index.end() || tit == csr_.index.end()) {
+            throw std::invalid_argument("source or target node doesn't exist");
+        }
+        pending_.push_back({sit->second, tit->second});
+        return pending_.size() - 1;
+    }
+
+    std::size_t pending() const noexcept { return pending_.size(); }
+
+    // Answers every pending query and clears the queue. With with_paths ==
+    // false only distances are filled. PathResult::settled is the size of the
+    // group search that answered the query.
+    std::vector<PathResult<Id, Weight>> run(bool with_paths = true) {
+        std::vector<PathResult<Id, Weight>> results(pending_.size());
+        if (pending_.empty()) return results;
+
+        // dedup: sort (source, target), unique[k] answers every query mapped to k
+        std::vector<std::pair<std::size_t, std::size_t>> unique(pending_);
+        std::sort(unique.begin(), unique.end());
+        unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+        // groups: [group_begin[g], group_begin[g + 1]) share a source
+        std::vector<std::size_t> group_begin;
+        for (std::size_t k = 0; k < unique.size(); ++k) {
+            if (k == 0 || unique[k].first != unique[k - 1].first) group_begin.push_back(k);
+        }
+        group_begin.push_back(unique.size());
+
+        std::vector<PathResult<Id, Weight>> answers(unique.size());
+        pool_.parallel_for(group_begin.size() - 1, [&](std::size_t begin, std::size_t end, std::size_t worker) {
+            if (!workspaces_[worker]) workspaces_[worker].emplace(csr_);
+            auto &ws = *workspaces_[worker];
+            auto &mark = mark_[worker];
+            if (mark.size() != csr_.node_count()) mark.assign(csr_.node_count(), 0);
+
+            for (std::size_t g = begin; g < end; ++g) {
+                const std::size_t first = group_begin[g], last = group_begin[g + 1];
+                for (std::size_t k = first; k < last; ++k) mark[unique[k].second] = 1;
+                std::size_t remaining = last - first;
+                std::size_t settled = ws.run_until(unique[first].first, [&](std::size_t u, Weight) {
+                    if (!mark[u]) return false;
+                    mark[u] = 0;
+                    return --remaining == 0;
+                });
+                for (std::size_t k = first; k < last; ++k) {
+                    const std::size_t t = unique[k].second;
+                    mark[t] = 0;
+                    answers[k].settled = settled;
+                    if (!ws.reached(csr_.ids[t])) continue;
+                    answers[k].distance = ws.distance(csr_.ids[t]);
+                    if (with_paths) answers[k].path = ws.path_to(csr_.ids[t]);
+                }
+            }
+        }, 1);
+
+        for (std::size_t q = 0; q < pending_.size(); ++q) {
+            auto k = std::lower_bound(unique.begin(), unique.end(), pending_[q]) - unique.begin();
+            results[q] = answers[k];
+        }
+        pending_.clear();
+        return results;
+    }
+
+private:
+    const CsrGraph<Id, Weight> &csr_;
+    ThreadPool &pool_;
+    std::vector<std::pair<std::size_t, std::size_t>> pending_;  // (source, target) indexes
+    std::vector<std::vector<char>> mark_;                       // per worker: pending target flags
+    std::vector<std::optional<DijkstraWorkspace<Id, Weight>>> workspaces_;
+};
+
+// Graph wrapper: answers 'queries' in order. threads == 0 -> hardware_concurrency().
+template <typename G, typename Extractor>
+auto batch_shortest_paths(const G &g,
+                          const std::vector<std::pair<typename G::id_type, typename G::id_type>> &queries,
+                          Extractor extractor,
+                          std::size_t threads = 0,
+                          bool with_paths = true)
+{
+    auto csr = make_csr(g, extractor);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    BatchQueryEngine engine(csr, pool);
+    for (const auto &[s, t] : queries) engine.submit(s, t);
+    return engine.run(with_paths);
+}
+
+// ------------------ Topological sort (Kahn) ------------------
+template <typename G>
+std::vector<typename G::id_type> topological_sort(const G &g) {
+    using id_type = typename G::id_type;
+    if (!g.directed()) throw std::logic_error("Topological sort requires a directed graph");
+
+    std::unordered_map<id_type, int> indeg;
+    for (const auto &p : g.list_nodes()) indeg[p.first] = 0;
+    for (const auto &e : g.list_edges()) {
+        id_type to = std::get<1>(e);
+        indeg[to]++; 
+    }
+
+    std::queue<id_type> q;
+    for (const auto &kv : indeg) if (kv.second == 0) q.push(kv.first);
+
+    std::vector<id_type> order;
+    while (!q.empty()) {
+        id_type u = q.front(); q.pop();
+        order.push_back(u);
+        for (const auto &edge : g.neighbors(u)) {
+            id_type v = edge.first;
+            indeg[v]--;
+            if (indeg[v] == 0) q.push(v);
+        }
+    }
+
+    if (order.size() != indeg.size()) {
+        throw std::runtime_error("Graph has at least one cycle (topo sort failed)");
+    }
+    return order;
+}
+
+// ------------------ Shortest / longest paths on DAGs ------------------
+// One relaxation sweep in topological order: when u comes up every arc into
+// u has already been relaxed, so dist[u] is final and each arc is looked at
+// exactly once. O(V + E), negative weights are fine since there is no cycle to
+// go around. Longest paths are the same sweep with max instead of min, which is
+// what critical-path scheduling needs.
+
+// Kahn on a CSR snapshot. In-degrees are counted per arc, so parallel edges are
+// handled. Throws std::runtime_error when the graph has a cycle.
+template <typename Id, typename Weight>
+std::vector<std::size_t> topological_order_dense(const CsrGraph<Id, Weight> &csr) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::size_t> indeg(n, 0), order;
+    order.reserve(n);
+    for (std::size_t v : csr.targets) indeg[v]++;
+    for (std::size_t u = 0; u < n; ++u) if (indeg[u] == 0) order.push_back(u);
+    // order doubles as the FIFO queue: everything before head has been expanded
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        std::size_t u = order[head];
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+            if (--indeg[csr.targets[e]] == 0) order.push_back(csr.targets[e]);
+    }
+    if (order.size() != n) throw std::runtime_error("Graph has at least one cycle (topo sort failed)");
+    return order;
+}
+
+namespace detail {
+
+// Longest == false: min-sweep from start, unreachable nodes keep weight_infinity().
+// Longest == true : max-sweep from start, unreachable nodes keep weight_negative_infinity().
+template <bool Longest, typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+dag_sweep(const CsrGraph<Id, Weight> &csr, const std::vector<std::size_t> &order, std::size_t start) {
+    const std::size_t n = csr.node_count();
+    const Weight UNREACHED = Longest ? weight_negative_infinity<Weight>() : weight_infinity<Weight>();
+    std::vector<Weight> dist(n, UNREACHED);
+    std::vector<std::size_t> prev(n, npos);
+    dist[start] = Weight{0};
+
+    for (std::size_t u : order) {
+        if (dist[u] == UNREACHED) continue;
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            Weight nd = dist[u] + csr.weights[e];
+            if (Longest ? nd > dist[v] : nd < dist[v]) { dist[v] = nd; prev[v] = u; }
+        }
+    }
+    return {std::move(dist), std::move(prev)};
+}
+
+} // namespace detail
+
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+dag_shortest_paths_dense(const CsrGraph<Id, Weight> &csr, const std::vector<std::size_t> &order, std::size_t start) {
+    return detail::dag_sweep<false>(csr, order, start);
+}
+
+template <typename Id, typename Weight>
+std::pair<std::vector<Weight>, std::vector<std::size_t>>
+dag_longest_paths_dense(const CsrGraph<Id, Weight> &csr, const std::vector<std::size_t> &order, std::size_t start) {
+    return detail::dag_sweep<true>(csr, order, start);
+}
+
+// Critical path of a task DAG where arc weights are durations. Every node may
+// start at time 0: earliest[v] is the longest path ending at v, latest[v] is
+// length minus the longest path starting at v, and slack = latest - earliest
+// (0 on every critical node). path is one longest path, source to sink.
+template <typename Id, typename Weight>
+struct CriticalPath {
+    std::vector<Id> ids;
+    std::unordered_map<Id, std::size_t> index;
+    std::vector<Weight> earliest;
+    std::vector<Weight> latest;
+    Weight length{};
+    std::vector<Id> path;
+
+    Weight slack(const Id &id) const {
+        std::size_t i = index.at(id);
+        return latest[i] - earliest[i];
+    }
+};
+
+template <typename Id, typename Weight>
+CriticalPath<Id, Weight> critical_path_dense(const CsrGraph<Id, Weight> &csr, const std::vector<std::size_t> &order) {
+    const std::size_t n = csr.node_count();
+    CriticalPath<Id, Weight> r;
+    r.ids = csr.ids;
+    r.index = csr.index;
+    r.earliest.assign(n, Weight{0});
+    r.latest.assign(n, Weight{0});
+    std::vector<std::size_t> prev(n, detail::npos);
+    if (n == 0) return r;
+
+    for (std::size_t u : order) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            Weight nd = r.earliest[u] + csr.weights[e];
+            if (nd > r.earliest[v]) { r.earliest[v] = nd; prev[v] = u; }
+        }
+    }
+    std::size_t last = static_cast<std::size_t>(std::max_element(r.earliest.begin(), r.earliest.end()) - r.earliest.begin());
+    r.length = r.earliest[last];
+
+    // tail[u]: longest path starting at u, filled in reverse order (kept in latest)
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        std::size_t u = *it;
+        Weight tail{0};
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+            tail = std::max(tail, r.latest[csr.targets[e]] + csr.weights[e]);
+        r.latest[u] = tail;
+    }
+    for (auto &l : r.latest) l = r.length - l;
+
+    for (std::size_t v = last; v != detail::npos; v = prev[v]) r.path.push_back(csr.ids[v]);
+    std::reverse(r.path.begin(), r.path.end());
+    return r;
+}
+
+// DagPaths: keeps the CSR snapshot and topological order of g and reuses them
+// for every query until g.revision() changes, so repeated queries on an
+// unchanged pipeline skip the O(V + E) rebuild and the topological sort.
+// g must outlive the DagPaths object.
+template <typename G, typename Extractor>
+class DagPaths {
+public:
+    using id_type = typename G::id_type;
+    using weight_type = std::decay_t<decltype(std::declval<Extractor>()(std::declval<typename G::edge_property_type>()))>;
+    using csr_type = CsrGraph<id_type, weight_type>;
+
+    DagPaths(const G &g, Extractor extractor) : g_(&g), extractor_(extractor) {}
+
+    const csr_type &csr() { refresh(); return csr_; }
+    const std::vector<std::size_t> &order() { refresh(); return order_; }
+
+    // Same result shape as dijkstra(): unreachable nodes keep weight_infinity().
+    auto shortest_paths(const id_type &start) {
+        std::size_t s = start_index(start);
+        auto [dist, prev] = dag_shortest_paths_dense(csr_, order_, s);
+        return detail::to_maps(csr_, dist, prev);
+    }
+
+    // Unreachable nodes keep weight_negative_infinity().
+    auto longest_paths(const id_type &start) {
+        std::size_t s = start_index(start);
+        auto [dist, prev] = dag_longest_paths_dense(csr_, order_, s);
+        return detail::to_maps(csr_, dist, prev);
+    }
+
+    // Same searches with a ShortestPathTree result; all trees share one IdTable
+    // per graph revision.
+    ShortestPathTree<id_type, weight_type> shortest_tree(const id_type &start) {
+        std::size_t s = start_index(start);
+        auto [dist, prev] = dag_shortest_paths_dense(csr_, order_, s);
+        return {table_, std::move(dist), std::move(prev), s};
+    }
+
+    ShortestPathTree<id_type, weight_type> longest_tree(const id_type &start) {
+        std::size_t s = start_index(start);
+        auto [dist, prev] = dag_longest_paths_dense(csr_, order_, s);
+        return {table_, std::move(dist), std::move(prev), s};
+    }
+
+    CriticalPath<id_type, weight_type> critical_path() {
+        refresh();
+        return critical_path_dense(csr_, order_);
+    }
+
+private:
+    void refresh() {
+        if (built_ && revision_ == g_->revision()) return;
+        if (!g_->directed()) throw std::logic_error("DAG paths require a directed graph");
+        csr_ = make_csr(*g_, extractor_);
+        order_ = topological_order_dense(csr_);
+        table_ = detail::id_table(csr_);
+        revision_ = g_->revision();
+        built_ = true;
+    }
+
+    std::size_t start_index(const id_type &start) {
+        if (!g_->has_node(start)) throw std::invalid_argument("start node doesn't exist");
+        refresh();
+        return csr_.index.at(start);
+    }
+
+    const G *g_;
+    Extractor extractor_;
+    csr_type csr_;
+    std::vector<std::size_t> order_;
+    std::shared_ptr<const IdTable<id_type>> table_;
+    std::uint64_t revision_ = 0;
+    bool built_ = false;
+};
+
+// One-shot wrappers; hold a DagPaths to reuse the snapshot across queries.
+template <typename G, typename Extractor>
+auto dag_shortest_paths(const G &g, const typename G::id_type &start, Extractor extractor) {
+    return DagPaths<G, Extractor>(g, extractor).shortest_paths(start);
+}
+
+template <typename G, typename Extractor>
+auto dag_longest_paths(const G &g, const typename G::id_type &start, Extractor extractor) {
+    return DagPaths<G, Extractor>(g, extractor).longest_paths(start);
+}
+
+template <typename G, typename Extractor>
+auto critical_path(const G &g, Extractor extractor) {
+    return DagPaths<G, Extractor>(g, extractor).critical_path();
+}
+
+// ------------------ Incremental topological order (Pearce-Kelly) ------------------
+// Keeps a topological order of a growing DAG. Inserting u -> v when u already
+// comes before v costs O(1). Otherwise only the affected region between
+// ord[v] and ord[u] is searched: forward from v (nodes with ord <= ord[u]) and
+// backward from u (nodes with ord >= ord[v]). If the forward search reaches u,
+// the edge would close a cycle and is rejected; otherwise the two visited sets
+// are reordered among their own positions (backward set first). The cost is
+// proportional to the affected nodes and their edges, not to the graph size.
+template <typename Id>
+class IncrementalTopologicalOrder {
+public:
+    using id_type = Id;
+
+    IncrementalTopologicalOrder() = default;
+
+    // Starts from g's nodes and edges. Throws std::runtime_error if g has a cycle.
+    template <typename G>
+    explicit IncrementalTopologicalOrder(const G &g) {
+        auto csr = make_csr_topology(g);
+        for (std::size_t i : topological_order_dense(csr)) add_node(csr.ids[i]);
+        for (std::size_t u = 0; u < csr.node_count(); ++u)
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+                link(index_.at(csr.ids[u]), index_.at(csr.ids[csr.targets[e]]));
+    }
+
+    std::size_t node_count() const noexcept { return ids_.size(); }
+    bool has_node(const Id &id) const { return index_.count(id) != 0; }
+
+    // New nodes go to the end of the order. Returns false if id already exists.
+    bool add_node(const Id &id) {
+        if (has_node(id)) return false;
+        std::size_t i = ids_.size();
+        index_.emplace(id, i);
+        ids_.push_back(id);
+        out_.emplace_back();
+        in_.emplace_back();
+        ord_.push_back(i);
+        at_.push_back(i);
+        mark_.push_back(0);
+        parent_.push_back(detail::npos);
+        return true;
+    }
+
+    // Inserts from -> to (creating missing nodes) unless it would close a cycle.
+    // On rejection returns false and, if cycle != nullptr, stores the cycle as
+    // from, to, ..., from.
+    bool try_add_edge(const Id &from, const Id &to, std::vector<Id> *cycle = nullptr) {
+        add_node(from);
+        add_node(to);
+        const std::size_t u = index_.at(from), v = index_.at(to);
+        if (u == v) {
+            if (cycle) *cycle = {from, from};
+            return false;
+        }
+        if (ord_[u] < ord_[v]) { link(u, v); return true; }
+
+        const std::size_t lb = ord_[v], ub = ord_[u];
+        ++stamp_;
+        std::vector<std::size_t> fwd, bwd;
+        if (!forward(v, u, ub, fwd)) {
+            if (cycle) {
+                cycle->clear();
+                cycle->push_back(from);
+                for (std::size_t x = u; x != detail::npos; x = parent_[x]) cycle->push_back(ids_[x]);
+                std::reverse(cycle->begin() + 1, cycle->end()); // from, to, ..., from
+            }
+            return false;
+        }
+        backward(u, lb, bwd);
+        reorder(bwd, fwd);
+        link(u, v);
+        return true;
+    }
+
+    // Removing edges never invalidates the order. Like Graph::remove_edge, every
+    // copy of from -> to goes.
+    bool remove_edge(const Id &from, const Id &to) {
+        auto fu = index_.find(from), tv = index_.find(to);
+        if (fu == index_.end() || tv == index_.end()) return false;
+        const std::size_t u = fu->second, v = tv->second;
+        auto &out = out_[u];
+        auto &in = in_[v];
+        const std::size_t before = out.size();
+        out.erase(std::remove(out.begin(), out.end(), v), out.end());
+        in.erase(std::remove(in.begin(), in.end(), u), in.end());
+        return out.size() != before;
+    }
+
+    std::size_t position(const Id &id) const { return ord_[index_.at(id)]; }
+
+    std::vector<Id> order() const {
+        std::vector<Id> out;
+        out.reserve(at_.size());
+        for (std::size_t i : at_) out.push_back(ids_[i]);
+        return out;
+    }
+
+private:
+    void link(std::size_t u, std::size_t v) {
+        out_[u].push_back(v);
+        in_[v].push_back(u);
+    }
+
+    // DFS from v over nodes with ord <= ub; false as soon as target is reached
+    // (parent_ then leads from target back to v).
+    bool forward(std::size_t v, std::size_t target, std::size_t ub, std::vector<std::size_t> &seen) {
+        std::vector<std::size_t> stack{v};
+        mark_[v] = stamp_;
+        parent_[v] = detail::npos;
+        while (!stack.empty()) {
+            std::size_t x = stack.back(); stack.pop_back();
+            seen.push_back(x);
+            for (std::size_t y : out_[x]) {
+                if (y == target) { parent_[y] = x; return false; }
+                if (mark_[y] == stamp_ || ord_[y] > ub) continue;
+                mark_[y] = stamp_;
+                parent_[y] = x;
+                stack.push_back(y);
+            }
+        }
+        return true;
+    }
+
+    // DFS from u against the arcs over nodes with ord >= lb.
+    void backward(std::size_t u, std::size_t lb, std::vector<std::size_t> &seen) {
+        std::vector<std::size_t> stack{u};
+        mark_[u] = stamp_;
+        while (!stack.empty()) {
+            std::size_t x = stack.back(); stack.pop_back();
+            seen.push_back(x);
+            for (std::size_t y : in_[x]) {
+                if (mark_[y] == stamp_ || ord_[y] < lb) continue;
+                mark_[y] = stamp_;
+                stack.push_back(y);
+            }
+        }
+    }
+
+    // The positions both sets held, ascending, are handed out again: first to
+    // the backward set, then to the forward set, each in its previous order.
+    void reorder(std::vector<std::size_t> &bwd, std::vector<std::size_t> &fwd) {
+        auto by_ord = [&](std::size_t a, std::size_t b) { return ord_[a] < ord_[b]; };
+        std::sort(bwd.begin(), bwd.end(), by_ord);
+        std::sort(fwd.begin(), fwd.end(), by_ord);
+        std::vector<std::size_t> slots;
+        slots.reserve(bwd.size() + fwd.size());
+        for (std::size_t x : bwd) slots.push_back(ord_[x]);
+        for (std::size_t x : fwd) slots.push_back(ord_[x]);
+        std::sort(slots.begin(), slots.end());
+        std::size_t k = 0;
+        for (std::size_t x : bwd) { ord_[x] = slots[k]; at_[slots[k++]] = x; }
+        for (std::size_t x : fwd) { ord_[x] = slots[k]; at_[slots[k++]] = x; }
+    }
+
+    std::vector<Id> ids_;
+    std::unordered_map<Id, std::size_t> index_;
+    std::vector<std::vector<std::size_t>> out_, in_;
+    std::vector<std::size_t> ord_;   // node -> position
+    std::vector<std::size_t> at_;    // position -> node
+    std::vector<std::uint64_t> mark_;
+    std::vector<std::size_t> parent_;
+    std::uint64_t stamp_ = 0;
+};
+
+// ------------------ Topological levels (wavefront scheduling) ------------------
+// Level i holds every node whose predecessors all sit in levels < i, so the
+// nodes of one level can run in parallel once the previous levels are done.
+// Kahn's algorithm one frontier at a time: the pool splits the frontier, each
+// arc decrements the head's in-degree atomically, and whoever brings it to zero
+// puts the head into the next level. Each level is sorted by snapshot index,
+// so the result does not depend on the thread count. Throws std::runtime_error
+// on a cycle.
+template <typename Id, typename Weight>
+std::vector<std::vector<std::size_t>> topological_levels_dense(const CsrGraph<Id, Weight> &csr, ThreadPool &pool) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::atomic<std::size_t>> indeg(n);
+    for (std::size_t v : csr.targets) indeg[v].fetch_add(1, std::memory_order_relaxed);
+
+    std::vector<std::vector<std::size_t>> levels;
+    std::vector<std::size_t> frontier;
+    for (std::size_t v = 0; v < n; ++v) if (indeg[v].load(std::memory_order_relaxed) == 0) frontier.push_back(v);
+    std::size_t placed = 0;
+    while (!frontier.empty()) {
+        placed += frontier.size();
+        std::vector<std::size_t> next = detail::expand_frontier(frontier, pool, [&](std::size_t u, std::vector<std::size_t> &out) {
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+                if (indeg[csr.targets[e]].fetch_sub(1, std::memory_order_acq_rel) == 1) out.push_back(csr.targets[e]);
+        });
+        std::sort(next.begin(), next.end());
+        levels.push_back(std::move(frontier));
+        frontier = std::move(next);
+    }
+    if (placed != n) throw std::runtime_error("Graph has at least one cycle (topo sort failed)");
+    return levels;
+}
+
+template <typename G>
+std::vector<std::vector<typename G::id_type>> topological_levels(const G &g, std::size_t threads = 0) {
+    if (!g.directed()) throw std::logic_error("Topological sort requires a directed graph");
+    auto csr = make_csr_topology(g);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    auto levels = topological_levels_dense(csr, pool);
+    std::vector<std::vector<typename G::id_type>> out(levels.size());
+    for (std::size_t l = 0; l < levels.size(); ++l)
+        for (std::size_t v : levels[l]) out[l].push_back(csr.ids[v]);
+    return out;
+}
+
+// Streaming mode: a node is handed to on_ready(v, worker) as soon as its
+// in-degree hits zero, without waiting for the rest of its level, and its
+// successors are released when on_ready returns - so on_ready can run the job
+// itself and the pool works as a dependency-driven executor. Ready nodes wait
+// in a shared FIFO; workers stop when the queue is empty and no node is in
+// flight. Throws std::runtime_error afterwards if a cycle kept nodes from ever
+// becoming ready; an exception from on_ready stops the other workers and is
+// rethrown.
+template <typename Id, typename Weight, typename OnReady>
+void topological_stream_dense(const CsrGraph<Id, Weight> &csr, ThreadPool &pool, OnReady on_ready) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::atomic<std::size_t>> indeg(n);
+    for (std::size_t v : csr.targets) indeg[v].fetch_add(1, std::memory_order_relaxed);
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::size_t> ready;
+    std::size_t in_flight = 0, finished = 0;
+    bool abort = false;
+    for (std::size_t v = 0; v < n; ++v) if (indeg[v].load(std::memory_order_relaxed) == 0) ready.push_back(v);
+
+    pool.run([&](std::size_t worker) {
+        std::vector<std::size_t> released;
+        while (true) {
+            std::size_t u;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return abort || !ready.empty() || in_flight == 0; });
+                if (abort || ready.empty()) return; // nothing queued and nothing running
+                u = ready.front();
+                ready.pop_front();
+                ++in_flight;
+            }
+            try {
+                on_ready(u, worker);
+            } catch (...) {
+                { std::lock_guard<std::mutex> lock(m); abort = true; }
+                cv.notify_all();
+                throw;
+            }
+            released.clear();
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e)
+                if (indeg[csr.targets[e]].fetch_sub(1, std::memory_order_acq_rel) == 1) released.push_back(csr.targets[e]);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                ready.insert(ready.end(), released.begin(), released.end());
+                --in_flight;
+                ++finished;
+            }
+            cv.notify_all();
+        }
+    });
+    if (finished != n) throw std::runtime_error("Graph has at least one cycle (topo sort failed)");
+}
+
+template <typename G, typename OnReady>
+void topological_stream(const G &g, OnReady on_ready, std::size_t threads = 0) {
+    if (!g.directed()) throw std::logic_error("Topological sort requires a directed graph");
+    auto csr = make_csr_topology(g);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    topological_stream_dense(csr, pool, [&](std::size_t v, std::size_t worker) { on_ready(csr.ids[v], worker); });
+}
+
+// ---------- utility: pair hash for unordered_map keys ----------
+template <typename A, typename B>
+struct PairHash {
+    std::size_t operator()(const std::pair<A,B>& p) const noexcept {
+        // combine two hashes (works for most std::hash<A/B> specializations)
+        std::size_t ha = std::hash<A>{}(p.first);
+        std::size_t hb = std::hash<B>{}(p.second);
+        // simple combination
+        return ha ^ (hb + 0x9e3779b97f4a7c15ULL + (ha<<6) + (ha>>2));
+    }
+};
+
+// ------------------ Bipartite check (dense) ------------------
+// Two-coloring by BFS straight over a snapshot's out-arcs plus, for directed
+// graphs, the in-arcs of its transpose (in == nullptr when csr already stores
+// every edge both ways, as for an undirected Graph) - no second adjacency map.
+// color receives 0/1 per snapshot index (a valid two-coloring when the result
+// is true). When it is false and odd_cycle != nullptr, odd_cycle receives a
+// cycle of odd length c0, ..., c0: the conflicting edge (u, v) joins two nodes
+// of the same BFS depth, so walking up the BFS tree from both in lockstep meets
+// at their common ancestor.
+namespace detail {
+
+inline std::vector<std::size_t> odd_cycle_from(const std::vector<std::size_t> &parent, std::size_t u, std::size_t v) {
+    std::vector<std::size_t> up, down;
+    for (std::size_t a = u, b = v; ; a = parent[a], b = parent[b]) {
+        up.push_back(a);
+        if (a == b) break;
+        down.push_back(b);
+    }
+    up.insert(up.end(), down.rbegin(), down.rend());
+    up.push_back(u);
+    return up;
+}
+
+// Calls fn(w) for every neighbor of u in the undirected view.
+template <typename Id, typename Weight, typename Fn>
+void for_each_undirected(const CsrGraph<Id, Weight> &out, const CsrGraph<Id, Weight> *in, std::size_t u, Fn fn) {
+    for (std::size_t e = out.offsets[u]; e < out.offsets[u + 1]; ++e) fn(out.targets[e]);
+    if (in) for (std::size_t e = in->offsets[u]; e < in->offsets[u + 1]; ++e) fn(in->targets[e]);
+}
+
+} // namespace detail
+
+template <typename Id, typename Weight>
+bool bipartite_dense(const CsrGraph<Id, Weight> &out, const CsrGraph<Id, Weight> *in,
+                     std::vector<unsigned char> &color, std::vector<std::size_t> *odd_cycle = nullptr)
+{
+    const std::size_t n = out.node_count();
+    constexpr unsigned char NONE = 2;
+    color.assign(n, NONE);
+    std::vector<std::size_t> parent(n, detail::npos), queue;
+    queue.reserve(n);
+    for (std::size_t r = 0; r < n; ++r) {
+        if (color[r] != NONE) continue;
+        color[r] = 0;
+        queue.assign(1, r);
+        for (std::size_t h = 0; h < queue.size(); ++h) {
+            const std::size_t u = queue[h];
+            std::size_t clash = detail::npos;
+            detail::for_each_undirected(out, in, u, [&](std::size_t w) {
+                if (color[w] == NONE) { color[w] = color[u] ^ 1; parent[w] = u; queue.push_back(w); }
+                else if (color[w] == color[u] && clash == detail::npos) clash = w;
+            });
+            if (clash != detail::npos) {
+                if (odd_cycle) *odd_cycle = detail::odd_cycle_from(parent, u, clash);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Same result with every connected component colored by a level-synchronous
+// BFS on the pool (a CAS on the color claims each node once), then one parallel
+// sweep over the edges looking for a same-colored pair. The coloring is the
+// depth parity from the lowest-index node of each component, so it does not
+// depend on the thread count; the odd cycle may.
+template <typename Id, typename Weight>
+bool bipartite_parallel_dense(const CsrGraph<Id, Weight> &out, const CsrGraph<Id, Weight> *in, ThreadPool &pool,
+                              std::vector<unsigned char> &color, std::vector<std::size_t> *odd_cycle = nullptr)
+{
+    const std::size_t n = out.node_count();
+    constexpr unsigned char NONE = 2;
+    std::vector<std::atomic<unsigned char>> shared(n);
+    for (auto &c : shared) c.store(NONE, std::memory_order_relaxed);
+    std::vector<std::size_t> parent(n, detail::npos);
+
+    for (std::size_t r = 0; r < n; ++r) {
+        if (shared[r].load(std::memory_order_relaxed) != NONE) continue;
+        shared[r].store(0, std::memory_order_relaxed);
+        std::vector<std::size_t> frontier{r};
+        while (!frontier.empty()) {
+            frontier = detail::expand_frontier(frontier, pool, [&](std::size_t u, std::vector<std::size_t> &next) {
+                const unsigned char c = shared[u].load(std::memory_order_relaxed) ^ 1;
+                detail::for_each_undirected(out, in, u, [&](std::size_t w) {
+                    unsigned char expected = NONE;
+                    if (shared[w].compare_exchange_strong(expected, c, std::memory_order_relaxed)) {
+                        parent[w] = u;
+                        next.push_back(w);
+                    }
+                });
+            });
+        }
+    }
+
+    color.resize(n);
+    for (std::size_t v = 0; v < n; ++v) color[v] = shared[v].load(std::memory_order_relaxed);
+
+    // lowest u with a clash, so at least the reported edge is deterministic
+    std::atomic<std::size_t> clash_u{detail::npos};
+    std::vector<std::size_t> clash_w(pool.size(), detail::npos), clash_at(pool.size(), detail::npos);
+    pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        for (std::size_t u = begin; u < end && u < clash_u.load(std::memory_order_relaxed); ++u) {
+            std::size_t hit = detail::npos;
+            detail::for_each_undirected(out, in, u, [&](std::size_t w) {
+                if (hit == detail::npos && color[w] == color[u]) hit = w;
+            });
+            if (hit == detail::npos) continue;
+            if (u < clash_at[worker]) { clash_at[worker] = u; clash_w[worker] = hit; }
+            std::size_t cur = clash_u.load();
+            while (u < cur && !clash_u.compare_exchange_weak(cur, u)) {}
+            break;
+        }
+    });
+    const std::size_t u = clash_u.load();
+    if (u == detail::npos) return true;
+    if (odd_cycle) {
+        std::size_t w = detail::npos;
+        for (std::size_t k = 0; k < pool.size(); ++k) if (clash_at[k] == u) w = clash_w[k];
+        *odd_cycle = detail::odd_cycle_from(parent, u, w);
+    }
+    return false;
+}
+
+// Bipartition: the two sides, or an odd cycle (ids, first == last) when the
+// graph is not bipartite.
+template <typename Id>
+struct Bipartition {
+    bool bipartite = true;
+    std::vector<Id> left;
+    std::vector<Id> right;
+    std::vector<Id> odd_cycle;
+};
+
+namespace detail {
+
+template <typename G, typename Run>
+Bipartition<typename G::id_type> bipartition_with(const G &g, Run run) {
+    auto csr = make_csr_topology(g);
+    std::optional<decltype(csr)> in;
+    if (g.directed()) in = csr.transpose();
+    std::vector<unsigned char> color;
+    std::vector<std::size_t> cycle;
+    Bipartition<typename G::id_type> r;
+    r.bipartite = run(csr, in ? &*in : nullptr, color, &cycle);
+    if (!r.bipartite) {
+        for (std::size_t v : cycle) r.odd_cycle.push_back(csr.ids[v]);
+        return r;
+    }
+    for (std::size_t v = 0; v < csr.node_count(); ++v) (color[v] ? r.right : r.left).push_back(csr.ids[v]);
+    return r;
+}
+
+} // namespace detail
+
+template <typename G>
+Bipartition<typename G::id_type> bipartition(const G &g) {
+    return detail::bipartition_with(g, [](const auto &out, const auto *in, auto &color, auto *cycle) {
+        return bipartite_dense(out, in, color, cycle);
+    });
+}
+
+// threads == 0 -> hardware_concurrency().
+template <typename G>
+Bipartition<typename G::id_type> bipartition_parallel(const G &g, std::size_t threads = 0) {
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    return detail::bipartition_with(g, [&](const auto &out, const auto *in, auto &color, auto *cycle) {
+        return bipartite_parallel_dense(out, in, pool, color, cycle);
+    });
+}
+
+// -----------------------------------------------------------------
+// Bipartite check (treats graph as undirected).
+//    Directed graphs are colored over their out- and in-arcs.
+//    Returns true if graph is bipartite, false otherwise.
+//    bipartition(g) also returns the sides or an odd cycle.
+// -----------------------------------------------------------------
+template <typename G>
+bool is_bipartite(const G &g) {
+    auto csr = make_csr_topology(g);
+    std::vector<unsigned char> color;
+    if (!g.directed()) return bipartite_dense(csr, static_cast<decltype(csr) *>(nullptr), color);
+    auto in = csr.transpose();
+    return bipartite_dense(csr, &in, color);
+}
+
+// ------------------ Cycle detection (dense) ------------------
+// find_directed_cycle_dense: three-color DFS with an explicit stack and edge
+// cursors. An arc into a gray node closes a cycle, and the gray nodes on the
+// stack from that node up to the top are the cycle. Returns true when a cycle
+// exists; if cycle != nullptr it receives the snapshot indices c0, c1, ..., c0.
+template <typename Id, typename Weight>
+bool find_directed_cycle_dense(const CsrGraph<Id, Weight> &csr, std::vector<std::size_t> *cycle = nullptr) {
+    const std::size_t n = csr.node_count();
+    std::vector<unsigned char> color(n, 0); // 0 white, 1 gray (on the stack), 2 black
+    std::vector<std::size_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1), stack;
+    for (std::size_t r = 0; r < n; ++r) {
+        if (color[r]) continue;
+        color[r] = 1;
+        stack.push_back(r);
+        while (!stack.empty()) {
+            std::size_t u = stack.back();
+            if (cursor[u] == csr.offsets[u + 1]) {
+                color[u] = 2;
+                stack.pop_back();
+                continue;
+            }
+            std::size_t v = csr.targets[cursor[u]++];
+            if (color[v] == 0) { color[v] = 1; stack.push_back(v); }
+            else if (color[v] == 1) {
+                if (cycle) {
+                    auto it = std::find(stack.begin(), stack.end(), v);
+                    cycle->assign(it, stack.end());
+                    cycle->push_back(v);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// find_undirected_cycle_dense: one sweep over the edges with union-find (path
+// halving, union by size); the first edge whose ends are already connected
+// closes a cycle. symmetric == true means csr stores every edge both ways (an
+// undirected Graph), so only arcs u -> v with u <= v are swept. Self-loops and
+// parallel edges count as cycles. The witness is the forest path between the
+// two ends of the closing edge, found only once a cycle exists.
+template <typename Id, typename Weight>
+bool find_undirected_cycle_dense(const CsrGraph<Id, Weight> &csr, bool symmetric, std::vector<std::size_t> *cycle = nullptr) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::size_t> parent(n), size(n, 1);
+    for (std::size_t i = 0; i < n; ++i) parent[i] = i;
+    auto find = [&](std::size_t x) {
+        while (parent[x] != x) { parent[x] = parent[parent[x]]; x = parent[x]; }
+        return x;
+    };
+
+    std::vector<std::pair<std::size_t, std::size_t>> forest; // only kept for the witness
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            if (symmetric && v < u) continue;
+            std::size_t a = find(u), b = find(v);
+            if (a != b) {
+                if (size[a] < size[b]) std::swap(a, b);
+                parent[b] = a;
+                size[a] += size[b];
+                if (cycle) forest.emplace_back(u, v);
+                continue;
+            }
+            if (!cycle) return true;
+            // closing edge v - u, then the forest path from u back to v
+            std::vector<std::size_t> off(n + 1, 0), adj(2 * forest.size()), prev(n, detail::npos);
+            for (const auto &[x, y] : forest) { off[x + 1]++; off[y + 1]++; }
+            for (std::size_t i = 0; i < n; ++i) off[i + 1] += off[i];
+            std::vector<std::size_t> pos(off.begin(), off.end() - 1);
+            for (const auto &[x, y] : forest) { adj[pos[x]++] = y; adj[pos[y]++] = x; }
+            std::vector<std::size_t> queue{v};
+            prev[v] = v;
+            for (std::size_t h = 0; h < queue.size() && prev[u] == detail::npos; ++h)
+                for (std::size_t i = off[queue[h]]; i < off[queue[h] + 1]; ++i)
+                    if (prev[adj[i]] == detail::npos) { prev[adj[i]] = queue[h]; queue.push_back(adj[i]); }
+            cycle->clear();
+            cycle->push_back(v);
+            for (std::size_t x = u; x != v; x = prev[x]) cycle->push_back(x);
+            cycle->push_back(v);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Cycle as node ids (first == last), empty when g is acyclic. Directed graphs
+// use find_directed_cycle_dense, undirected ones the union-find sweep.
+template <typename G>
+std::vector<typename G::id_type> find_cycle(const G &g) {
+    auto csr = make_csr_topology(g);
+    std::vector<std::size_t> cycle;
+    bool found = g.directed() ? find_directed_cycle_dense(csr, &cycle)
+                              : find_undirected_cycle_dense(csr, true, &cycle);
+    std::vector<typename G::id_type> out;
+    if (found) for (std::size_t i : cycle) out.push_back(csr.ids[i]);
+    return out;
+}
+
+// -----------------------------------------------------------------
+// Acyclic check
+//    - For directed graphs: iterative DFS color method (back-edges).
+//    - For undirected graphs: union-find over the edges; parallel edges and
+//      self-loops count as cycles.
+//    Both run on a dense snapshot; find_cycle(g) also returns the cycle.
+// -----------------------------------------------------------------
+template <typename G>
+bool is_acyclic(const G &g) {
+    auto csr = make_csr_topology(g);
+    return g.directed() ? !find_directed_cycle_dense(csr) : !find_undirected_cycle_dense(csr, true);
+}
+
+// ------------------ Strongly connected components (dense) ------------------
+// Both searches walk the snapshot with an explicit stack and a per-node edge
+// cursor (next arc to look at), so depth is bounded by memory, not by the
+// call stack, and there is no std::function call per vertex.
+
+// ComponentLabels: component[i] in 0..count-1 for every snapshot index i.
+struct ComponentLabels {
+    std::vector<std::size_t> component;
+    std::size_t count = 0;
+
+    // Snapshot indices grouped by component, in component order.
+    std::vector<std::vector<std::size_t>> groups() const {
+        std::vector<std::vector<std::size_t>> out(count);
+        for (std::size_t i = 0; i < component.size(); ++i) out[component[i]].push_back(i);
+        return out;
+    }
+};
+
+// Kosaraju: finish order on csr, then collect components on the transpose in
+// reverse finish order. Components come out in topological order of the
+// condensation (component 0 has no incoming arcs from other components).
+template <typename Id, typename Weight>
+ComponentLabels kosaraju_scc_dense(const CsrGraph<Id, Weight> &csr) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::size_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1);
+    std::vector<char> visited(n, 0);
+    std::vector<std::size_t> order, stack;
+    order.reserve(n);
+
+    for (std::size_t r = 0; r < n; ++r) {
+        if (visited[r]) continue;
+        visited[r] = 1;
+        stack.push_back(r);
+        while (!stack.empty()) {
+            std::size_t u = stack.back();
+            if (cursor[u] < csr.offsets[u + 1]) {
+                std::size_t v = csr.targets[cursor[u]++];
+                if (!visited[v]) { visited[v] = 1; stack.push_back(v); }
+            } else {
+                stack.pop_back();
+                order.push_back(u); // finished: every descendant is done
+            }
+        }
+    }
+
+    const CsrGraph<Id, Weight> rev = csr.transpose();
+    ComponentLabels r;
+    r.component.assign(n, detail::npos);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (r.component[*it] != detail::npos) continue;
+        r.component[*it] = r.count;
+        stack.push_back(*it);
+        while (!stack.empty()) {
+            std::size_t u = stack.back(); stack.pop_back();
+            for (std::size_t e = rev.offsets[u]; e < rev.offsets[u + 1]; ++e) {
+                std::size_t v = rev.targets[e];
+                if (r.component[v] == detail::npos) { r.component[v] = r.count; stack.push_back(v); }
+            }
+        }
+        r.count++;
+    }
+    return r;
+}
+
+// Tarjan in Pearce's single-array form: one pass, no transpose. rindex[v] is
+// the DFS index while v is open and is overwritten with n - 1 - component once
+// v's component is closed; those values are above every live index, so closed
+// nodes never lower rindex again and need no separate on-stack flag.
+// Components come out in reverse topological order (component 0 is a sink).
+template <typename Id, typename Weight>
+ComponentLabels tarjan_scc_dense(const CsrGraph<Id, Weight> &csr) {
+    const std::size_t n = csr.node_count();
+    std::vector<std::size_t> rindex(n, 0);
+    std::vector<std::size_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1);
+    std::vector<char> root(n, 0);
+    std::vector<std::size_t> call, members; // DFS path / open non-root nodes
+    std::size_t index = 1, count = 0;
+
+    auto open = [&](std::size_t v) { rindex[v] = index++; root[v] = 1; call.push_back(v); };
+
+    for (std::size_t r = 0; r < n; ++r) {
+        if (rindex[r] != 0) continue;
+        open(r);
+        while (!call.empty()) {
+            std::size_t v = call.back();
+            if (cursor[v] < csr.offsets[v + 1]) {
+                std::size_t w = csr.targets[cursor[v]];
+                // unvisited: descend and look at this arc again once w is done
+                if (rindex[w] == 0) { open(w); continue; }
+                if (rindex[w] < rindex[v]) { rindex[v] = rindex[w]; root[v] = 0; }
+                cursor[v]++;
+                continue;
+            }
+            call.pop_back();
+            if (!root[v]) { members.push_back(v); continue; }
+            const std::size_t label = n - 1 - count;
+            index--;
+            while (!members.empty() && rindex[v] <= rindex[members.back()]) {
+                rindex[members.back()] = label;
+                members.pop_back();
+                index--;
+            }
+            rindex[v] = label;
+            count++;
+        }
+    }
+
+    ComponentLabels res;
+    res.count = count;
+    res.component.resize(n);
+    for (std::size_t v = 0; v < n; ++v) res.component[v] = n - 1 - rindex[v];
+    return res;
+}
+
+namespace detail {
+
+template <typename Id, typename Weight>
+std::vector<std::vector<Id>> group_ids(const CsrGraph<Id, Weight> &csr, const ComponentLabels &labels) {
+    std::vector<std::vector<Id>> out(labels.count);
+    for (std::size_t i = 0; i < csr.node_count(); ++i) out[labels.component[i]].push_back(csr.ids[i]);
+    return out;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------
+// Kosaraju's algorithm for Strongly Connected Components (SCCs)
+//    Works for directed graphs. For undirected graphs it will return
+//    connected components (each SCC will equal a connected component).
+//    Returns vector<vector<id_type>> where each inner vector is one component,
+//    in topological order of the condensation. Runs kosaraju_scc_dense on a
+//    snapshot, so long chains don't overflow the stack.
+// -----------------------------------------------------------------
+template <typename G>
+std::vector<std::vector<typename G::id_type>> kosaraju_scc(const G &g) {
+    auto csr = make_csr_topology(g);
+    return detail::group_ids(csr, kosaraju_scc_dense(csr));
+}
+
+// Same components from tarjan_scc_dense (one pass, no reversed graph), in
+// reverse topological order of the condensation.
+template <typename G>
+std::vector<std::vector<typename G::id_type>> tarjan_scc(const G &g) {
+    auto csr = make_csr_topology(g);
+    return detail::group_ids(csr, tarjan_scc_dense(csr));
+}
+
+// ------------------ Parallel SCC (trim + forward-backward + coloring) ------------------
+// Multistep decomposition on a CSR snapshot and its transpose:
+//   1) trim: a vertex with no in-arcs or no out-arcs from the remaining vertices
+//      (self-loops ignored) is an SCC of its own. Degrees are atomic counters;
+//      removing a vertex decrements its neighbors and whoever brings one to zero
+//      claims it, so chains peel off in O(V + E) total.
+//   2) forward-backward: from the vertex with the largest in*out degree,
+//      the intersection of forward and backward reach is one SCC, normally the
+//      giant one.
+//   3) coloring, repeated until nothing is left: every vertex takes the largest
+//      index that reaches it (max-label propagation with CAS); a vertex whose
+//      color is its own index is a root, and the vertices of that color that
+//      reach it form its SCC. Roots have disjoint color classes, so their
+//      backward searches run in parallel without locks.
+//   4) a long chain of small SCCs needs one coloring round per prefix maximum,
+//      so once a round removes less than 1/8 of what is left, the rest is
+//      finished by tarjan_scc_dense on the induced subgraph.
+// BFS frontiers of 1024 or more vertices are split across the pool.
+//
+// The SCCs found do not depend on scheduling. Components are numbered by their
+// smallest snapshot index, so the labels are the same for any thread count; the
+// partition matches kosaraju_scc_dense up to the numbering.
+
+template <typename Id, typename Weight>
+ComponentLabels parallel_scc_dense(const CsrGraph<Id, Weight> &csr, ThreadPool &pool) {
+    const std::size_t n = csr.node_count();
+    const CsrGraph<Id, Weight> rev = csr.transpose();
+    std::vector<std::size_t> rep(n, detail::npos);          // representative of v's SCC
+    std::vector<std::atomic<unsigned char>> done(n);        // v already has a representative
+    auto alive = [&](std::size_t v) { return done[v].load(std::memory_order_relaxed) == 0; };
+
+    // 1) trim
+    std::vector<std::atomic<std::size_t>> indeg(n), outdeg(n);
+    pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t v = begin; v < end; ++v) {
+            std::size_t in = 0, out = 0;
+            for (std::size_t e = rev.offsets[v]; e < rev.offsets[v + 1]; ++e) in += rev.targets[e] != v;
+            for (std::size_t e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e) out += csr.targets[e] != v;
+            indeg[v].store(in, std::memory_order_relaxed);
+            outdeg[v].store(out, std::memory_order_relaxed);
+        }
+    });
+    std::vector<std::size_t> frontier;
+    for (std::size_t v = 0; v < n; ++v)
+        if (indeg[v].load() == 0 || outdeg[v].load() == 0) { done[v].store(1); frontier.push_back(v); }
+    auto claim = [&](std::size_t v, std::vector<std::size_t> &out) {
+        if (done[v].exchange(1) == 0) out.push_back(v);
+    };
+    while (!frontier.empty()) {
+        frontier = detail::expand_frontier(frontier, pool, [&](std::size_t v, std::vector<std::size_t> &out) {
+            rep[v] = v;
+            for (std::size_t e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e) {
+                std::size_t w = csr.targets[e];
+                if (w != v && indeg[w].fetch_sub(1) == 1) claim(w, out);
+            }
+            for (std::size_t e = rev.offsets[v]; e < rev.offsets[v + 1]; ++e) {
+                std::size_t u = rev.targets[e];
+                if (u != v && outdeg[u].fetch_sub(1) == 1) claim(u, out);
+            }
+        });
+    }
+
+    // 2) forward-backward from the highest-degree survivor
+    std::size_t pivot = detail::npos, best = 0;
+    for (std::size_t v = 0; v < n; ++v) {
+        if (!alive(v)) continue;
+        std::size_t score = indeg[v].load() * outdeg[v].load();
+        if (pivot == detail::npos || score > best) { pivot = v; best = score; }
+    }
+    if (pivot != detail::npos) {
+        std::vector<std::atomic<unsigned char>> fw(n), bw(n);
+        auto reach = [&](const CsrGraph<Id, Weight> &graph, std::vector<std::atomic<unsigned char>> &seen) {
+            seen[pivot].store(1);
+            std::vector<std::size_t> level{pivot};
+            while (!level.empty()) {
+                level = detail::expand_frontier(level, pool, [&](std::size_t v, std::vector<std::size_t> &out) {
+                    for (std::size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                        std::size_t w = graph.targets[e];
+                        if (alive(w) && seen[w].exchange(1) == 0) out.push_back(w);
+                    }
+                });
+            }
+        };
+        reach(csr, fw);
+        reach(rev, bw);
+        pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t v = begin; v < end; ++v)
+                if (fw[v].load() && bw[v].load()) { rep[v] = pivot; done[v].store(1); }
+        });
+    }
+
+    // 3) coloring rounds on whatever is left
+    std::vector<std::size_t> active;
+    for (std::size_t v = 0; v < n; ++v) if (alive(v)) active.push_back(v);
+    std::vector<std::atomic<std::size_t>> color(n);
+    std::vector<std::atomic<unsigned char>> queued(n);
+    while (!active.empty()) {
+        for (std::size_t v : active) { color[v].store(v); queued[v].store(1); }
+        frontier = active;
+        while (!frontier.empty()) {
+            frontier = detail::expand_frontier(frontier, pool, [&](std::size_t v, std::vector<std::size_t> &out) {
+                queued[v].store(0);
+                const std::size_t c = color[v].load();
+                for (std::size_t e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e) {
+                    std::size_t w = csr.targets[e];
+                    if (!alive(w)) continue;
+                    std::size_t cur = color[w].load();
+                    bool raised = false;
+                    while (cur < c && !(raised = color[w].compare_exchange_weak(cur, c))) {}
+                    if (raised && queued[w].exchange(1) == 0) out.push_back(w);
+                }
+            });
+        }
+
+        std::vector<std::size_t> roots;
+        for (std::size_t v : active) if (color[v].load() == v) roots.push_back(v);
+        pool.parallel_for(roots.size(), [&](std::size_t begin, std::size_t end, std::size_t) {
+            std::vector<std::size_t> stack;
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::size_t r = roots[i];
+                rep[r] = r;
+                done[r].store(1);
+                stack.push_back(r);
+                while (!stack.empty()) {
+                    std::size_t v = stack.back(); stack.pop_back();
+                    for (std::size_t e = rev.offsets[v]; e < rev.offsets[v + 1]; ++e) {
+                        std::size_t u = rev.targets[e];
+                        // color first: only this root's search touches color-r vertices
+                        if (color[u].load() != r || !alive(u)) continue;
+                        rep[u] = r;
+                        done[u].store(1);
+                        stack.push_back(u);
+                    }
+                }
+            }
+        }, 1);
+        const std::size_t before = active.size();
+        std::erase_if(active, [&](std::size_t v) { return !alive(v); });
+        if ((before - active.size()) * 8 < before) break;
+    }
+
+    // 4) sequential finish on the induced subgraph of the survivors
+    if (!active.empty()) {
+        std::vector<std::size_t> local(n, detail::npos);
+        for (std::size_t i = 0; i < active.size(); ++i) local[active[i]] = i;
+        CsrGraph<Id, Weight> sub;
+        sub.offsets.push_back(0);
+        for (std::size_t v : active) {
+            sub.ids.push_back(csr.ids[v]);
+            for (std::size_t e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+                if (local[csr.targets[e]] != detail::npos) sub.targets.push_back(local[csr.targets[e]]);
+            sub.offsets.push_back(sub.targets.size());
+        }
+        ComponentLabels rest = tarjan_scc_dense(sub);
+        std::vector<std::size_t> first(rest.count, detail::npos);
+        for (std::size_t i = 0; i < active.size(); ++i) {
+            std::size_t &f = first[rest.component[i]];
+            if (f == detail::npos) f = active[i];
+            rep[active[i]] = f;
+        }
+    }
+
+    // number components by their smallest vertex index
+    ComponentLabels r;
+    r.component.assign(n, detail::npos);
+    std::vector<std::size_t> label(n, detail::npos);
+    for (std::size_t v = 0; v < n; ++v) {
+        std::size_t &l = label[rep[v]];
+        if (l == detail::npos) l = r.count++;
+        r.component[v] = l;
+    }
+    return r;
+}
+
+// Graph wrapper: same result shape as kosaraju_scc(). threads == 0 -> hardware_concurrency().
+template <typename G>
+std::vector<std::vector<typename G::id_type>> parallel_scc(const G &g, std::size_t threads = 0) {
+    auto csr = make_csr_topology(g);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    return detail::group_ids(csr, parallel_scc_dense(csr, pool));
+}
+
+// ------------------ Condensation DAG ------------------
+// Condensation: one DAG node per SCC, numbered in topological order (every arc
+// of dag goes from a lower to a higher component). dag.weights holds the number
+// of original arcs merged into each DAG arc, so a weight of 1 marks an arc that
+// rests on a single road/dependency. dag is a regular CsrGraph, so the DAG
+// algorithms (topological_order_dense, dag_longest_paths_dense, ...) run on it.
+template <typename Id>
+struct Condensation {
+    std::vector<Id> ids;                       // snapshot index -> node id
+    std::vector<std::size_t> component;        // snapshot index -> DAG node
+    CsrGraph<std::size_t, std::size_t> dag;    // weights = arc multiplicity
+
+    std::size_t size() const noexcept { return dag.node_count(); }
+
+    // Node ids of every DAG node.
+    std::vector<std::vector<Id>> members() const {
+        std::vector<std::vector<Id>> out(size());
+        for (std::size_t i = 0; i < ids.size(); ++i) out[component[i]].push_back(ids[i]);
+        return out;
+    }
+};
+
+// Tarjan for the components, then one counting-sort pass over the arcs grouped
+// by source component; last[c] remembers where the arc to c was written for
+// the current source, so multiplicities need no hashing. O(V + E).
+template <typename Id, typename Weight>
+Condensation<Id> condensation_dense(const CsrGraph<Id, Weight> &csr) {
+    const std::size_t n = csr.node_count();
+    ComponentLabels scc = tarjan_scc_dense(csr);
+    const std::size_t k = scc.count;
+
+    Condensation<Id> r;
+    r.ids = csr.ids;
+    r.component.resize(n);
+    for (std::size_t v = 0; v < n; ++v) r.component[v] = k - 1 - scc.component[v]; // Tarjan emits sinks first
+
+    // vertices bucketed by component
+    std::vector<std::size_t> start(k + 1, 0), byc(n);
+    for (std::size_t v = 0; v < n; ++v) start[r.component[v] + 1]++;
+    for (std::size_t c = 0; c < k; ++c) start[c + 1] += start[c];
+    std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+    for (std::size_t v = 0; v < n; ++v) byc[pos[r.component[v]]++] = v;
+
+    auto &dag = r.dag;
+    dag.ids.resize(k);
+    dag.index.reserve(k);
+    for (std::size_t c = 0; c < k; ++c) { dag.ids[c] = c; dag.index.emplace(c, c); }
+    dag.offsets.assign(k + 1, 0);
+    std::vector<std::size_t> last(k, detail::npos);
+    for (std::size_t c = 0; c < k; ++c) {
+        for (std::size_t i = start[c]; i < start[c + 1]; ++i) {
+            std::size_t u = byc[i];
+            for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                std::size_t d = r.component[csr.targets[e]];
+                if (d == c) continue;
+                if (last[d] == detail::npos || last[d] < dag.offsets[c]) {
+                    last[d] = dag.targets.size();
+                    dag.targets.push_back(d);
+                    dag.weights.push_back(0);
+                }
+                dag.weights[last[d]]++;
+            }
+        }
+        dag.offsets[c + 1] = dag.targets.size();
+    }
+    return r;
+}
+
+template <typename G>
+Condensation<typename G::id_type> condensation(const G &g) {
+    return condensation_dense(make_csr_topology(g));
+}
+
+// ------------------ Bridges, articulation points, biconnected components ------------------
+// One iterative DFS over the undirected view of the snapshot computes tin/low
+// and, from them, all three results; edges are numbered so a parallel edge back
+// to the parent counts as a back edge (as dfs_br_func in bee1442 does with
+// parent_eid) and is never mistaken for the tree edge.
+//
+// The undirected view: for symmetric == true (csr of an undirected Graph, every
+// edge stored both ways) the arcs u -> v with u < v are the edges; otherwise
+// every arc is one edge (edge e is arc e when there are no self-loops).
+// Self-loops are left out of edges.
+struct Biconnectivity {
+    std::vector<std::pair<std::size_t, std::size_t>> edges; // edge -> (u, v) snapshot indices
+    std::vector<char> is_bridge;                             // per edge
+    std::vector<char> is_articulation;                       // per vertex
+    std::vector<std::size_t> edge_component;                 // per edge, 0..component_count-1
+    std::size_t component_count = 0;
+};
+
+template <typename Id, typename Weight>
+Biconnectivity biconnectivity_dense(const CsrGraph<Id, Weight> &csr, bool symmetric) {
+    const std::size_t n = csr.node_count();
+    Biconnectivity r;
+    for (std::size_t u = 0; u < n; ++u)
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            std::size_t v = csr.targets[e];
+            if (u != v && (!symmetric || u < v)) r.edges.emplace_back(u, v);
+        }
+    const std::size_t m = r.edges.size();
+    r.is_bridge.assign(m, 0);
+    r.is_articulation.assign(n, 0);
+    r.edge_component.assign(m, detail::npos);
+
+    // incidence lists: (neighbor, edge) both ways
+    std::vector<std::size_t> off(n + 1, 0);
+    for (const auto &[u, v] : r.edges) { off[u + 1]++; off[v + 1]++; }
+    for (std::size_t i = 0; i < n; ++i) off[i + 1] += off[i];
+    std::vector<std::pair<std::size_t, std::size_t>> inc(off[n]);
+    std::vector<std::size_t> fill(off.begin(), off.end() - 1);
+    for (std::size_t e = 0; e < m; ++e) {
+        auto [u, v] = r.edges[e];
+        inc[fill[u]++] = {v, e};
+        inc[fill[v]++] = {u, e};
+    }
+
+    std::vector<std::size_t> tin(n, detail::npos), low(n, 0), parent_edge(n, detail::npos);
+    std::vector<std::size_t> cursor(off.begin(), off.end() - 1), call, edge_stack;
+    std::size_t timer = 0;
+    for (std::size_t root = 0; root < n; ++root) {
+        if (tin[root] != detail::npos) continue;
+        tin[root] = low[root] = timer++;
+        call.push_back(root);
+        std::size_t root_children = 0;
+        while (!call.empty()) {
+            std::size_t u = call.back();
+            if (cursor[u] < off[u + 1]) {
+                auto [v, e] = inc[cursor[u]++];
+                if (e == parent_edge[u]) continue;
+                if (tin[v] == detail::npos) {
+                    parent_edge[v] = e;
+                    tin[v] = low[v] = timer++;
+                    edge_stack.push_back(e);
+                    call.push_back(v);
+                } else if (tin[v] < tin[u]) {       // back edge, seen from the lower end
+                    low[u] = std::min(low[u], tin[v]);
+                    edge_stack.push_back(e);
+                }
+                continue;
+            }
+            call.pop_back();
+            if (call.empty()) break;
+            std::size_t p = call.back();
+            low[p] = std::min(low[p], low[u]);
+            if (low[u] > tin[p]) r.is_bridge[parent_edge[u]] = 1;
+            if (low[u] >= tin[p]) {
+                // p separates u's subtree: everything stacked since the tree edge is one block
+                if (p == root) root_children++;
+                else r.is_articulation[p] = 1;
+                std::size_t e;
+                do {
+                    e = edge_stack.back(); edge_stack.pop_back();
+                    r.edge_component[e] = r.component_count;
+                } while (e != parent_edge[u]);
+                r.component_count++;
+            }
+        }
+        if (root_children >= 2) r.is_articulation[root] = 1;
+    }
+    return r;
+}
+
+namespace detail {
+
+template <typename G>
+std::pair<CsrGraph<typename G::id_type, unsigned char>, Biconnectivity> biconnectivity_of(const G &g) {
+    auto csr = make_csr_topology(g);
+    Biconnectivity b = biconnectivity_dense(csr, !g.directed());
+    return {std::move(csr), std::move(b)};
+}
+
+} // namespace detail
+
+// Edges whose removal disconnects their endpoints (directed graphs: arcs taken
+// as undirected edges). Parallel edges are never bridges.
+template <typename G>
+std::vector<std::pair<typename G::id_type, typename G::id_type>> bridges(const G &g) {
+    auto [csr, b] = detail::biconnectivity_of(g);
+    std::vector<std::pair<typename G::id_type, typename G::id_type>> out;
+    for (std::size_t e = 0; e < b.edges.size(); ++e)
+        if (b.is_bridge[e]) out.emplace_back(csr.ids[b.edges[e].first], csr.ids[b.edges[e].second]);
+    return out;
+}
+
+// Vertices whose removal disconnects the rest of their connected component.
+template <typename G>
+std::vector<typename G::id_type> articulation_points(const G &g) {
+    auto [csr, b] = detail::biconnectivity_of(g);
+    std::vector<typename G::id_type> out;
+    for (std::size_t v = 0; v < csr.node_count(); ++v) if (b.is_articulation[v]) out.push_back(csr.ids[v]);
+    return out;
+}
+
+// Vertex sets of the biconnected components (blocks). Articulation points
+// belong to several blocks; isolated vertices belong to none.
+template <typename G>
+std::vector<std::vector<typename G::id_type>> biconnected_components(const G &g) {
+    auto [csr, b] = detail::biconnectivity_of(g);
+    std::vector<std::vector<std::size_t>> block_edges(b.component_count);
+    for (std::size_t e = 0; e < b.edges.size(); ++e) block_edges[b.edge_component[e]].push_back(e);
+    std::vector<std::vector<typename G::id_type>> out(b.component_count);
+    std::vector<std::size_t> seen(csr.node_count(), detail::npos); // last block a vertex was added to
+    for (std::size_t c = 0; c < b.component_count; ++c)
+        for (std::size_t e : block_edges[c])
+            for (std::size_t v : {b.edges[e].first, b.edges[e].second})
+                if (seen[v] != c) { seen[v] = c; out[c].push_back(csr.ids[v]); }
+    return out;
+}
+
+// ------------------ Max flow (residual arcs) ------------------
+// FlowNetwork: residual graph as contiguous arc arrays. Every edge u -> v of
+// the snapshot becomes arc a in u's range (capacity c) and its partner rev[a]
+// in v's range (capacity 0), so a push is two indexed writes instead of two
+// hash lookups. Arcs of node u are [offsets[u], offsets[u+1]); the tail of
+// arc a is head[rev[a]]. An undirected Graph stores each edge both ways and
+// therefore gets two arc pairs; parallel edges keep their own pairs.
+template <typename Id, typename Cap>
+struct FlowNetwork {
+    using id_type = Id;
+    using capacity_type = Cap;
+
+    std::vector<id_type> ids;                        // index -> id
+    std::unordered_map<id_type, std::size_t> index;  // id -> index
+    std::vector<std::size_t> offsets;                // size node_count() + 1
+    std::vector<std::size_t> head;                   // arc -> target index
+    std::vector<std::size_t> rev;                    // arc -> paired reverse arc
+    std::vector<capacity_type> capacity;             // arc -> original capacity (0 on reverse arcs)
+    std::vector<capacity_type> residual;             // arc -> capacity left
+
+    std::size_t node_count() const noexcept { return ids.size(); }
+    std::size_t arc_count() const noexcept { return head.size(); }
+
+    // Flow on arc a (negative on reverse arcs).
+    capacity_type flow(std::size_t a) const { return capacity[a] - residual[a]; }
+    // Back to the zero flow, e.g. before running a second algorithm.
+    void reset() { residual = capacity; }
+};
+
+template <typename Id, typename Cap>
+FlowNetwork<Id, Cap> make_flow_network(const CsrGraph<Id, Cap> &csr) {
+    static_assert(std::is_arithmetic<Cap>::value, "Capacity must be numeric");
+    const std::size_t n = csr.node_count();
+    FlowNetwork<Id, Cap> net;
+    net.ids = csr.ids;
+    net.index = csr.index;
+    net.offsets.assign(n + 1, 0);
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] < Cap(0)) throw std::invalid_argument("negative capacity encountered");
+            net.offsets[u + 1]++;
+            net.offsets[csr.targets[e] + 1]++;
+        }
+    }
+    for (std::size_t i = 0; i < n; ++i) net.offsets[i + 1] += net.offsets[i];
+    const std::size_t arcs = net.offsets[n];
+    net.head.resize(arcs);
+    net.rev.resize(arcs);
+    net.capacity.resize(arcs);
+    std::vector<std::size_t> pos(net.offsets.begin(), net.offsets.end() - 1);
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            const std::size_t v = csr.targets[e];
+            const std::size_t a = pos[u]++, b = pos[v]++;
+            net.head[a] = v; net.rev[a] = b; net.capacity[a] = csr.weights[e];
+            net.head[b] = u; net.rev[b] = a; net.capacity[b] = Cap(0);
+        }
+    }
+    net.residual = net.capacity;
+    return net;
+}
+
+// make_flow_network(g, cap_extractor): cap_extractor(edge_prop) -> Capacity.
+template <typename G, typename CapacityExtractor>
+auto make_flow_network(const G &g, CapacityExtractor cap_extractor) {
+    return make_flow_network(make_csr(g, cap_extractor));
+}
+
+// Edmonds-Karp on the arc arrays: BFS for a shortest augmenting path, push
+// its bottleneck, repeat. Adds to the flow already in net; returns the amount
+// added.
+template <typename Id, typename Cap>
+Cap edmonds_karp_dense(FlowNetwork<Id, Cap> &net, std::size_t s, std::size_t t) {
+    if (s == t) return Cap(0);
+    const std::size_t n = net.node_count();
+    std::vector<std::size_t> via(n), queue;   // via[v]: arc that reached v
+    queue.reserve(n);
+    Cap flow = Cap(0);
+    while (true) {
+        std::fill(via.begin(), via.end(), detail::npos);
+        queue.assign(1, s);
+        for (std::size_t h = 0; h < queue.size() && via[t] == detail::npos; ++h) {
+            const std::size_t u = queue[h];
+            for (std::size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a) {
+                const std::size_t v = net.head[a];
+                if (net.residual[a] > Cap(0) && v != s && via[v] == detail::npos) {
+                    via[v] = a;
+                    queue.push_back(v);
+                }
+            }
+        }
+        if (via[t] == detail::npos) return flow;
+
+        Cap bottleneck = weight_infinity<Cap>();
+        for (std::size_t v = t; v != s; v = net.head[net.rev[via[v]]])
+            bottleneck = std::min(bottleneck, net.residual[via[v]]);
+        for (std::size_t v = t; v != s; v = net.head[net.rev[via[v]]]) {
+            net.residual[via[v]] -= bottleneck;
+            net.residual[net.rev[via[v]]] += bottleneck;
+        }
+        flow += bottleneck;
+    }
+}
+
+// Dinic: BFS levels from s, then a blocking flow by iterative DFS along
+// level-increasing arcs. cur[u] (current arc) only moves forward within a
+// phase, so every arc is skipped at most once per phase: O(V^2 E) overall,
+// O(E sqrt(V)) on unit-capacity networks.
+template <typename Id, typename Cap>
+Cap dinic_dense(FlowNetwork<Id, Cap> &net, std::size_t s, std::size_t t) {
+    if (s == t) return Cap(0);
+    const std::size_t n = net.node_count();
+    std::vector<std::size_t> level(n), cur(n), queue, path;   // path: arcs from s
+    queue.reserve(n);
+    Cap flow = Cap(0);
+    while (true) {
+        std::fill(level.begin(), level.end(), detail::npos);
+        level[s] = 0;
+        queue.assign(1, s);
+        for (std::size_t h = 0; h < queue.size(); ++h) {
+            const std::size_t u = queue[h];
+            for (std::size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a) {
+                const std::size_t v = net.head[a];
+                if (net.residual[a] > Cap(0) && level[v] == detail::npos) {
+                    level[v] = level[u] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        if (level[t] == detail::npos) return flow;
+
+        std::copy(net.offsets.begin(), net.offsets.end() - 1, cur.begin());
+        path.clear();
+        std::size_t u = s;
+        while (true) {
+            if (u == t) {
+                Cap bottleneck = weight_infinity<Cap>();
+                for (std::size_t a : path) bottleneck = std::min(bottleneck, net.residual[a]);
+                std::size_t keep = path.size();
+                for (std::size_t i = path.size(); i-- > 0; ) {
+                    net.residual[path[i]] -= bottleneck;
+                    net.residual[net.rev[path[i]]] += bottleneck;
+                    if (net.residual[path[i]] == Cap(0)) keep = i;
+                }
+                flow += bottleneck;
+                path.resize(keep);   // resume from the tail of the first saturated arc
+                u = keep == 0 ? s : net.head[path.back()];
+                continue;
+            }
+            std::size_t &a = cur[u];
+            while (a < net.offsets[u + 1] &&
+                   !(net.residual[a] > Cap(0) && level[net.head[a]] == level[u] + 1)) ++a;
+            if (a < net.offsets[u + 1]) {
+                path.push_back(a);
+                u = net.head[a];
+                continue;
+            }
+            // dead end: retreat and skip the arc that led here
+            if (u == s) break;
+            level[u] = detail::npos;
+            path.pop_back();
+            u = path.empty() ? s : net.head[path.back()];
+            ++cur[u];
         }
     }
+}
 
-    // 2) First pass: order vertices by finish time (DFS)
-    std::unordered_map<id_type, bool> visited;
-    for (const auto &kv : adj) visited[kv.first] = false;
-    std::vector<id_type> order;
-    order.reserve(adj.size());
+namespace detail {
 
-    std::function<void(const id_type&)> dfs1 = [&](const id_type &u) {
-        visited[u] = true;
-        for (auto v : adj[u])
-            if (!visited[v]) dfs1(v);
-        order.push_back(u); // push after visiting descendants
+// One push-relabel pass that moves every excess it can toward `target`,
+// always discharging an active node of the highest label. `frozen` (the
+// source in the first pass, the sink in the second) keeps its excess and
+// label n. Labels are exact residual distances to target after each global
+// relabel (a reverse BFS, rerun after n relabels); nodes that cannot reach
+// target get label n and sit the pass out, and so does everything above a
+// label that empties out (gap heuristic).
+template <typename Id, typename Cap>
+void push_relabel_pass(FlowNetwork<Id, Cap> &net, std::vector<Cap> &excess,
+                       std::size_t target, std::size_t frozen)
+{
+    const std::size_t n = net.node_count();
+    std::vector<std::size_t> label(n), cur(n), count(n + 1), queue;
+    std::vector<std::vector<std::size_t>> active(n);
+    std::size_t highest = 0, relabels = 0;
+
+    auto global_relabel = [&] {
+        std::fill(label.begin(), label.end(), n);
+        std::fill(count.begin(), count.end(), 0);
+        for (auto &bucket : active) bucket.clear();
+        highest = 0;
+        label[target] = 0;
+        queue.assign(1, target);
+        for (std::size_t h = 0; h < queue.size(); ++h) {
+            const std::size_t v = queue[h];
+            count[label[v]]++;
+            for (std::size_t a = net.offsets[v]; a < net.offsets[v + 1]; ++a) {
+                const std::size_t w = net.head[a];
+                if (w != frozen && label[w] == n && net.residual[net.rev[a]] > Cap(0)) {
+                    label[w] = label[v] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        for (std::size_t v : queue) {
+            cur[v] = net.offsets[v];
+            if (v != target && excess[v] > Cap(0)) {
+                active[label[v]].push_back(v);
+                highest = std::max(highest, label[v]);
+            }
+        }
+        relabels = 0;
     };
 
-    for (const auto &kv : adj) {
-        if (!visited[kv.first]) dfs1(kv.first);
-    }
+    global_relabel();
+    while (true) {
+        while (highest > 0 && active[highest].empty()) --highest;
+        if (active[highest].empty()) return;
+        const std::size_t u = active[highest].back();
+        active[highest].pop_back();
+        if (label[u] != highest || excess[u] == Cap(0)) continue;   // lifted by a gap
 
-    // 3) Second pass: DFS on reversed graph in reverse finish order
-    for (auto &kv : visited) kv.second = false;
-    std::vector<std::vector<id_type>> components;
-    components.reserve(adj.size());
+        // discharge u
+        while (excess[u] > Cap(0)) {
+            std::size_t &a = cur[u];
+            if (a == net.offsets[u + 1]) {
+                std::size_t lowest = n;
+                for (std::size_t b = net.offsets[u]; b < net.offsets[u + 1]; ++b)
+                    if (net.residual[b] > Cap(0)) lowest = std::min(lowest, label[net.head[b]] + 1);
+                const std::size_t old = label[u];
+                if (--count[old] == 0) {
+                    // gap: nothing at label old is left to route through
+                    for (std::size_t v = 0; v < n; ++v)
+                        if (label[v] > old && label[v] < n) { count[label[v]]--; label[v] = n; }
+                    label[u] = n;
+                    break;
+                }
+                label[u] = std::min(lowest, n);
+                if (label[u] == n) break;
+                count[label[u]]++;
+                a = net.offsets[u];
+                if (++relabels == n) break;
+                continue;
+            }
+            const std::size_t v = net.head[a];
+            if (net.residual[a] > Cap(0) && label[u] == label[v] + 1) {
+                const Cap delta = std::min(excess[u], net.residual[a]);
+                net.residual[a] -= delta;
+                net.residual[net.rev[a]] += delta;
+                if (excess[v] == Cap(0) && v != target && v != frozen) {
+                    active[label[v]].push_back(v);   // u may have been relabeled past highest
+                    highest = std::max(highest, label[v]);
+                }
+                excess[u] -= delta;
+                excess[v] += delta;
+            } else {
+                ++a;
+            }
+        }
+        if (relabels == n) { global_relabel(); continue; }
+        if (excess[u] > Cap(0) && label[u] < n) {
+            active[label[u]].push_back(u);
+            highest = std::max(highest, label[u]);
+        }
+    }
+}
 
-    std::function<void(const id_type&, std::vector<id_type>&)> dfs2 =
-        [&](const id_type &u, std::vector<id_type> &comp) {
-            visited[u] = true;
-            comp.push_back(u);
-            for (auto v : rev_adj[u])
-                if (!visited[v]) dfs2(v, comp);
-        };
+} // namespace detail
 
-    for (auto it = order.rbegin(); it != order.rend(); ++it) {
-        id_type u = *it;
-        if (!visited[u]) {
-            components.emplace_back();
-            dfs2(u, components.back());
-        }
+// Highest-label push-relabel with global relabeling and the gap heuristic.
+// The first pass saturates the source arcs and pushes toward t, which leaves
+// the maximum preflow; the second pass returns the excess stranded behind the
+// cut to s, so net afterwards holds a valid flow. O(V^2 sqrt(E)).
+template <typename Id, typename Cap>
+Cap push_relabel_dense(FlowNetwork<Id, Cap> &net, std::size_t s, std::size_t t) {
+    if (s == t) return Cap(0);
+    std::vector<Cap> excess(net.node_count(), Cap(0));
+    for (std::size_t a = net.offsets[s]; a < net.offsets[s + 1]; ++a) {
+        const Cap c = net.residual[a];
+        if (c == Cap(0) || net.head[a] == s) continue;
+        net.residual[a] = Cap(0);
+        net.residual[net.rev[a]] += c;
+        excess[net.head[a]] += c;
     }
+    detail::push_relabel_pass(net, excess, t, s);
+    const Cap flow = excess[t];
+    detail::push_relabel_pass(net, excess, s, t);
+    return flow;
+}
 
-    return components;
+namespace detail {
+
+template <typename G, typename CapacityExtractor, typename Run>
+auto maxflow_with(const G &g, const typename G::id_type &source, const typename G::id_type &sink,
+                  CapacityExtractor cap_extractor, Run run)
+{
+    auto net = make_flow_network(g, cap_extractor);
+    auto s = net.index.find(source), t = net.index.find(sink);
+    if (s == net.index.end() || t == net.index.end()) {
+        throw std::invalid_argument("source or sink not present in graph");
+    }
+    return run(net, s->second, t->second);
 }
 
+} // namespace detail
+
 // -----------------------------------------------------------------
 // Max flow (Edmonds–Karp implementation - BFS augmenting paths)
 //    Requires a capacity extractor: cap_extractor(edge_prop) -> Capacity (arithmetic).
 //    The graph is treated as directed. If g is undirected, we add both directions
 //    with the same capacity (i.e., treat each undirected edge as two directed edges).
+//    dinic_maxflow / push_relabel_maxflow take the same arguments and are
+//    much faster on large networks.
 // -----------------------------------------------------------------
 template <typename G, typename CapacityExtractor>
 auto edmonds_karp_maxflow(const G &g,
@@ -419,99 +3883,30 @@ auto edmonds_karp_maxflow(const G &g,
                           CapacityExtractor cap_extractor)
     -> std::decay_t<decltype(cap_extractor(std::declval<typename G::edge_property_type>()))>
 {
-    using id_type = typename G::id_type;
-    using capacity_type = std::decay_t<decltype(cap_extractor(std::declval<typename G::edge_property_type>()))>;
-    static_assert(std::is_arithmetic<capacity_type>::value, "Capacity must be numeric");
-
-    // Build node list and index presence
-    std::unordered_set<id_type> nodes_set;
-    for (const auto &p : g.list_nodes()) nodes_set.insert(p.first);
-
-    if (!nodes_set.count(source) || !nodes_set.count(sink)) {
-        throw std::invalid_argument("source or sink not present in graph");
-    }
-
-    // Residual capacity map: (u,v) -> capacity
-    std::unordered_map<std::pair<id_type,id_type>, capacity_type, PairHash<id_type,id_type>> capacity;
-    std::unordered_map<id_type, std::vector<id_type>> adj; // adjacency for residual graph (neighbors with possible residual > 0)
-
-    // initialize adjacency entries
-    for (auto id : nodes_set) adj[id] = {};
-
-    // Initialize capacities from graph edges
-    for (const auto &e : g.list_edges()) {
-        id_type u = std::get<0>(e);
-        id_type v = std::get<1>(e);
-        capacity_type c = cap_extractor(std::get<2>(e));
-        if (c < capacity_type(0)) {
-            throw std::invalid_argument("negative capacity encountered");
-        }
-        // sum capacities when parallel edges exist
-        capacity[{u,v}] = capacity[{u,v}] + c;
-        // ensure reverse entry exists
-        if (!capacity.count({v,u})) capacity[{v,u}] = capacity_type(0);
-
-        // adjacency edges for residual graph (we'll keep all u->v and v->u present)
-        adj[u].push_back(v);
-        adj[v].push_back(u);
-    }
-
-    // Ensure every node has adjacency vector (including isolated)
-    for (const auto &p : g.list_nodes()) {
-        if (!adj.count(p.first)) adj[p.first] = {};
-    }
-
-    capacity_type flow = capacity_type(0);
-
-    // BFS to find augmenting path; returns parent map (node->prev_node) if found, else empty
-    auto bfs_find_path = [&](std::unordered_map<id_type, id_type> &parent) -> bool {
-        parent.clear();
-        std::queue<id_type> q;
-        std::unordered_set<id_type> visited;
-        q.push(source);
-        visited.insert(source);
-
-        while (!q.empty()) {
-            id_type u = q.front(); q.pop();
-            for (id_type v : adj[u]) {
-                // residual capacity u->v
-                capacity_type residual = capacity[{u,v}];
-                if (residual > capacity_type(0) && !visited.count(v)) {
-                    parent[v] = u;
-                    if (v == sink) return true;
-                    visited.insert(v);
-                    q.push(v);
-                }
-            }
-        }
-        return false;
-    };
+    return detail::maxflow_with(g, source, sink, cap_extractor,
+                                [](auto &net, std::size_t s, std::size_t t) { return edmonds_karp_dense(net, s, t); });
+}
 
-    std::unordered_map<id_type, id_type> parent;
-    while (bfs_find_path(parent)) {
-        // find bottleneck along the path sink <- ... <- source
-        capacity_type bottleneck = std::numeric_limits<capacity_type>::infinity();
-        id_type v = sink;
-        while (v != source) {
-            id_type u = parent[v];
-            capacity_type residual = capacity[{u,v}];
-            if (residual < bottleneck) bottleneck = residual;
-            v = u;
-        }
-        if (bottleneck == std::numeric_limits<capacity_type>::infinity()) break; // defensive
-
-        // apply flow along the path
-        v = sink;
-        while (v != source) {
-            id_type u = parent[v];
-            capacity[{u,v}] -= bottleneck;
-            capacity[{v,u}] += bottleneck; // reverse edge increases residual capacity
-            v = u;
-        }
-        flow += bottleneck;
-    }
+template <typename G, typename CapacityExtractor>
+auto dinic_maxflow(const G &g,
+                   const typename G::id_type &source,
+                   const typename G::id_type &sink,
+                   CapacityExtractor cap_extractor)
+    -> std::decay_t<decltype(cap_extractor(std::declval<typename G::edge_property_type>()))>
+{
+    return detail::maxflow_with(g, source, sink, cap_extractor,
+                                [](auto &net, std::size_t s, std::size_t t) { return dinic_dense(net, s, t); });
+}
 
-    return flow;
+template <typename G, typename CapacityExtractor>
+auto push_relabel_maxflow(const G &g,
+                          const typename G::id_type &source,
+                          const typename G::id_type &sink,
+                          CapacityExtractor cap_extractor)
+    -> std::decay_t<decltype(cap_extractor(std::declval<typename G::edge_property_type>()))>
+{
+    return detail::maxflow_with(g, source, sink, cap_extractor,
+                                [](auto &net, std::size_t s, std::size_t t) { return push_relabel_dense(net, s, t); });
 }
 
 // -----------------------------------------------------------------
@@ -533,7 +3928,7 @@ auto bellman_ford(const G &g,
     using Weight = std::decay_t<decltype(extractor(std::declval<typename G::edge_property_type>()))>;
     static_assert(std::is_arithmetic<Weight>::value, "Extractor must return arithmetic weight");
 
-    const Weight INF = std::numeric_limits<Weight>::infinity();
+    const Weight INF = weight_infinity<Weight>();
 
     // initialize distances & prev
     std::unordered_map<id_type, Weight> dist;
@@ -579,18 +3974,816 @@ auto bellman_ford(const G &g,
     return {std::move(dist), std::move(prev), has_negative};
 }
 
+// ------------------ Negative cycle detection ------------------
+// One Bellman-Ford-style run from a virtual super-source (every distance
+// starts at 0, so cycles anywhere in the graph are found), with Tarjan's
+// subtree disassembly: the shortest-path tree is kept as a preorder thread,
+// and before v is re-parented under u the subtree of v is cut out of the
+// tree. If u is inside that subtree, parent pointers from u lead back to v
+// and v -> ... -> u -> v is a negative cycle. Cut-out vertices are inactive
+// until relaxed again, which prunes most useless scans.
+//
+// Returns the cycle's node indexes in arc order (first -> ... -> last -> first),
+// or an empty vector if there is none. In that case the final labels are a
+// feasible potential (w(u, v) + p[u] - p[v] >= 0 on every arc), written to
+// *potential when given; johnson_apsp() reweights with it.
+template <typename Id, typename Weight>
+std::vector<std::size_t> find_negative_cycle_dense(const CsrGraph<Id, Weight> &csr,
+                                                   std::vector<Weight> *potential = nullptr)
+{
+    const std::size_t n = csr.node_count();
+    const std::size_t root = n;  // virtual super-source
+    const Weight INF = weight_infinity<Weight>();
+    std::vector<Weight> dist(n, Weight{0});
+    std::vector<std::size_t> parent(n + 1, root);
+    std::vector<std::size_t> depth(n + 1, 1);
+    parent[root] = detail::npos;
+    depth[root] = 0;
+    // preorder thread: root, 0, 1, ..., n-1
+    std::vector<std::size_t> next(n + 1, detail::npos), before(n + 1, detail::npos);
+    for (std::size_t i = 0, last = root; i < n; last = i++) {
+        next[last] = i;
+        before[i] = last;
+    }
+
+    std::vector<char> in_queue(n, 1);
+    std::deque<std::size_t> queue;
+    for (std::size_t i = 0; i < n; ++i) queue.push_back(i);
+
+    while (!queue.empty()) {
+        std::size_t u = queue.front(); queue.pop_front();
+        in_queue[u] = 0;
+        if (parent[u] == detail::npos) continue;  // cut out of the tree: label will improve
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] == INF) continue;
+            const std::size_t v = csr.targets[e];
+            const Weight nd = dist[u] + csr.weights[e];
+            if (!(nd < dist[v])) continue;
+            dist[v] = nd;
+
+            if (parent[v] != detail::npos) {
+                // v's subtree is the preorder run after v with greater depth;
+                // u inside it closes a cycle
+                std::size_t x = v;
+                do {
+                    if (x == u) {
+                        std::vector<std::size_t> cycle;
+                        for (std::size_t y = u; y != v; y = parent[y]) cycle.push_back(y);
+                        cycle.push_back(v);
+                        std::reverse(cycle.begin(), cycle.end());
+                        return cycle;
+                    }
+                    x = next[x];
+                } while (x != detail::npos && depth[x] > depth[v]);
+                // cut it: descendants become inactive, v is re-attached below
+                for (std::size_t y = next[v]; y != x; y = next[y]) parent[y] = detail::npos;
+                next[before[v]] = x;
+                if (x != detail::npos) before[x] = before[v];
+            }
+
+            // v becomes u's first child
+            parent[v] = u;
+            depth[v] = depth[u] + 1;
+            next[v] = next[u];
+            before[v] = u;
+            if (next[u] != detail::npos) before[next[u]] = v;
+            next[u] = v;
+
+            if (!in_queue[v]) {
+                in_queue[v] = 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    if (potential) *potential = std::move(dist);
+    return {};
+}
+
+// Graph wrapper: the node ids of one negative cycle, empty if there is none.
+template <typename G, typename Extractor>
+std::vector<typename G::id_type> find_negative_cycle(const G &g, Extractor extractor) {
+    auto csr = make_csr(g, extractor);
+    std::vector<typename G::id_type> cycle;
+    for (std::size_t i : find_negative_cycle_dense(csr)) cycle.push_back(csr.ids[i]);
+    return cycle;
+}
+
 // Convenience wrapper: check only boolean whether negative cycle exists anywhere
 template <typename G, typename Extractor>
 bool has_negative_cycle(const G &g, Extractor extractor) {
-    // using id_type = typename G::id_type;
-    // choose arbitrary start; run Bellman-Ford from each connected component (safer)
-    // We'll run Bellman-Ford with artificial super-source connecting to all nodes with 0 weight
-    // to detect negative cycles anywhere. To avoid changing Graph, do repeated BF from each node:
-    for (const auto &p : g.list_nodes()) {
-        auto [dist, prev, has_neg] = bellman_ford<G, Extractor>(g, p.first, extractor);
-        if (has_neg) return true;
+    return !find_negative_cycle(g, extractor).empty();
+}
+
+// ------------------ Queue-based Bellman-Ford (SPFA / Yen) ------------------
+// Dense-array alternatives to bellman_ford() for graphs with a few negative
+// arcs. Both return (dist, prev, has_negative_cycle) over csr indexes; when a
+// cycle is reported dist/prev are not shortest-path labels.
+
+// SPFA: only vertices whose label improved are rescanned, FIFO order, one
+// queue slot per vertex (in_queue flag). hops[v] counts the arcs on v's
+// current tentative path; reaching n means the path repeats a vertex, i.e. a
+// negative cycle reachable from start.
+template <typename Id, typename Weight>
+std::tuple<std::vector<Weight>, std::vector<std::size_t>, bool>
+spfa_dense(const CsrGraph<Id, Weight> &csr, std::size_t start)
+{
+    const std::size_t n = csr.node_count();
+    const Weight INF = weight_infinity<Weight>();
+    std::vector<Weight> dist(n, INF);
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::vector<std::size_t> hops(n, 0);
+    std::vector<char> in_queue(n, 0);
+    std::vector<std::size_t> ring(n);  // in_queue bounds the queue to n entries
+    std::size_t head = 0, size = 0;
+
+    dist[start] = Weight{0};
+    ring[0] = start; size = 1; in_queue[start] = 1;
+    while (size > 0) {
+        std::size_t u = ring[head];
+        head = head + 1 == n ? 0 : head + 1;
+        --size;
+        in_queue[u] = 0;
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] == INF) continue;
+            std::size_t v = csr.targets[e];
+            Weight nd = dist[u] + csr.weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                prev[v] = u;
+                hops[v] = hops[u] + 1;
+                if (hops[v] >= n) return {std::move(dist), std::move(prev), true};
+                if (!in_queue[v]) {
+                    in_queue[v] = 1;
+                    std::size_t tail = head + size;
+                    ring[tail >= n ? tail - n : tail] = v;
+                    ++size;
+                }
+            }
+        }
     }
-    return false;
+    return {std::move(dist), std::move(prev), false};
+}
+
+// Yen's ordering: arcs are split into "up" (u < v) and "down" (u >= v) by node
+// index. A pass sweeps vertices in ascending order relaxing up-arcs, then in
+// descending order relaxing down-arcs, so one pass settles any path made of one
+// ascending and one descending run; ceil(n / 2) passes suffice, half of plain
+// Bellman-Ford. A vertex's up- and down-arcs are only rescanned if its label
+// changed since they were last scanned.
+template <typename Id, typename Weight>
+std::tuple<std::vector<Weight>, std::vector<std::size_t>, bool>
+bellman_ford_yen_dense(const CsrGraph<Id, Weight> &csr, std::size_t start)
+{
+    const std::size_t n = csr.node_count();
+    const Weight INF = weight_infinity<Weight>();
+
+    // up-arcs (u < v) and down-arcs (u >= v, self-loops included) as two CSR arrays
+    std::vector<std::size_t> up_offsets(n + 1, 0), down_offsets(n + 1, 0);
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] == INF) continue;
+            (csr.targets[e] > u ? up_offsets : down_offsets)[u + 1]++;
+        }
+    }
+    for (std::size_t u = 0; u < n; ++u) {
+        up_offsets[u + 1] += up_offsets[u];
+        down_offsets[u + 1] += down_offsets[u];
+    }
+    std::vector<std::pair<std::size_t, Weight>> up(up_offsets[n]), down(down_offsets[n]);
+    for (std::size_t u = 0; u < n; ++u) {
+        std::size_t pu = up_offsets[u], pd = down_offsets[u];
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] == INF) continue;
+            if (csr.targets[e] > u) up[pu++] = {csr.targets[e], csr.weights[e]};
+            else down[pd++] = {csr.targets[e], csr.weights[e]};
+        }
+    }
+
+    std::vector<Weight> dist(n, INF);
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::vector<char> dirty_up(n, 0), dirty_down(n, 0);
+    dist[start] = Weight{0};
+    dirty_up[start] = dirty_down[start] = 1;
+
+    auto relax = [&](std::size_t u, const auto &arcs, const auto &offsets, bool &updated) {
+        for (std::size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            auto [v, w] = arcs[e];
+            Weight nd = dist[u] + w;
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                prev[v] = u;
+                dirty_up[v] = dirty_down[v] = 1;
+                updated = true;
+            }
+        }
+    };
+
+    const std::size_t passes = n / 2 + 2;
+    for (std::size_t pass = 0; pass < passes; ++pass) {
+        bool updated = false;
+        for (std::size_t u = 0; u < n; ++u) {
+            if (!dirty_up[u]) continue;
+            dirty_up[u] = 0;
+            relax(u, up, up_offsets, updated);
+        }
+        for (std::size_t u = n; u-- > 0;) {
+            if (!dirty_down[u]) continue;
+            dirty_down[u] = 0;
+            relax(u, down, down_offsets, updated);
+        }
+        if (!updated) return {std::move(dist), std::move(prev), false};
+    }
+    return {std::move(dist), std::move(prev), true};
+}
+
+// Graph wrappers: same result shape as bellman_ford(). Unlike bellman_ford(),
+// every arc is relaxed (parallel arcs and both directions of undirected edges).
+template <typename G, typename Extractor>
+auto spfa(const G &g, const typename G::id_type &start, Extractor extractor) {
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    auto [dist, prev, negative] = spfa_dense(csr, csr.index.at(start));
+    auto [dist_map, prev_map] = detail::to_maps(csr, dist, prev);
+    return std::make_tuple(std::move(dist_map), std::move(prev_map), negative);
+}
+
+template <typename G, typename Extractor>
+auto bellman_ford_yen(const G &g, const typename G::id_type &start, Extractor extractor) {
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    auto [dist, prev, negative] = bellman_ford_yen_dense(csr, csr.index.at(start));
+    auto [dist_map, prev_map] = detail::to_maps(csr, dist, prev);
+    return std::make_tuple(std::move(dist_map), std::move(prev_map), negative);
+}
+
+// bellman_ford() with a ShortestPathTree result; the bool is the negative-cycle flag.
+template <typename G, typename Extractor>
+auto bellman_ford_tree(const G &g, const typename G::id_type &start, Extractor extractor) {
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    std::size_t s = csr.index.at(start);
+    auto [dist, prev, negative] = bellman_ford_yen_dense(csr, s);
+    return std::make_pair(ShortestPathTree(detail::id_table(std::move(csr)), std::move(dist), std::move(prev), s), negative);
+}
+
+// ------------------ Parallel Bellman-Ford ------------------
+// Jacobi-style rounds on the transposed graph: round k reads dist_k and writes
+// dist_{k+1}, each vertex pulling over its in-arcs. Vertices are split across
+// the pool and every worker writes only its own slots, so there are no atomics
+// on the labels and the result does not depend on the thread count. Only
+// in-neighbors whose label changed in the previous round are relaxed, and a
+// shared flag ends the loop at the first round without updates.
+//
+// After k rounds dist holds the shortest distances over paths of at most k
+// arcs, so the distances and the negative-cycle flag match bellman_ford() (on
+// the arcs the CSR snapshot holds); prev is a shortest-path tree, ties broken
+// by in-arc order.
+template <typename Id, typename Weight>
+std::tuple<std::vector<Weight>, std::vector<std::size_t>, bool>
+bellman_ford_parallel_dense(const CsrGraph<Id, Weight> &csr, std::size_t start, ThreadPool &pool)
+{
+    const std::size_t n = csr.node_count();
+    const Weight INF = weight_infinity<Weight>();
+    const CsrGraph<Id, Weight> in = csr.transpose();
+
+    std::vector<Weight> dist(n, INF), next(n, INF);
+    std::vector<std::size_t> prev(n, detail::npos);
+    std::vector<char> changed(n, 0), changed_next(n, 0);
+    dist[start] = next[start] = Weight{0};
+    changed[start] = 1;
+
+    // rounds 1..n-1 converge, round n only runs to detect a negative cycle
+    for (std::size_t round = 1; round <= n; ++round) {
+        std::atomic<bool> updated{false};
+        pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+            bool local = false;
+            for (std::size_t v = begin; v < end; ++v) {
+                Weight best = dist[v];
+                std::size_t via = detail::npos;
+                for (std::size_t e = in.offsets[v]; e < in.offsets[v + 1]; ++e) {
+                    std::size_t u = in.targets[e];
+                    if (!changed[u] || in.weights[e] == INF) continue;
+                    Weight nd = dist[u] + in.weights[e];
+                    if (nd < best) { best = nd; via = u; }
+                }
+                next[v] = best;
+                changed_next[v] = via != detail::npos;
+                if (via != detail::npos) { prev[v] = via; local = true; }
+            }
+            if (local) updated.store(true, std::memory_order_relaxed);
+        });
+        if (!updated.load()) return {std::move(dist), std::move(prev), false};
+        dist.swap(next);
+        changed.swap(changed_next);
+    }
+    return {std::move(dist), std::move(prev), true};
+}
+
+// Graph wrapper: same result shape as bellman_ford(). threads == 0 -> hardware_concurrency().
+template <typename G, typename Extractor>
+auto bellman_ford_parallel(const G &g, const typename G::id_type &start, Extractor extractor, std::size_t threads = 0) {
+    if (!g.has_node(start)) throw std::invalid_argument("start node doesn't exist");
+    auto csr = make_csr(g, extractor);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    auto [dist, prev, negative] = bellman_ford_parallel_dense(csr, csr.index.at(start), pool);
+    auto [dist_map, prev_map] = detail::to_maps(csr, dist, prev);
+    return std::make_tuple(std::move(dist_map), std::move(prev_map), negative);
+}
+
+// ------------------ Johnson's all-pairs shortest paths ------------------
+// Sparse APSP with negative arcs: one super-source Bellman-Ford
+// (find_negative_cycle_dense) yields a potential p, arcs are reweighted to
+// w + p[u] - p[v] >= 0, and one Dijkstra per source runs on the reweighted
+// snapshot, sources split across the pool. Row values are corrected back:
+// dist(s, t) = dist'(s, t) - p[s] + p[t].
+//
+// on_row(source_index, std::span<const Weight> row) receives each row (indexed
+// like csr.ids, weight_infinity<Weight>() for unreachable) from the worker that
+// computed it, so callbacks run concurrently and the span is only valid during
+// the call. Returns a negative cycle (node indexes) and calls nothing if
+// there is one, otherwise an empty vector.
+template <typename Id, typename Weight, typename OnRow>
+std::vector<std::size_t> johnson_apsp_rows(const CsrGraph<Id, Weight> &csr, ThreadPool &pool, OnRow on_row) {
+    const std::size_t n = csr.node_count();
+    const Weight INF = weight_infinity<Weight>();
+    std::vector<Weight> p;
+    auto cycle = find_negative_cycle_dense(csr, &p);
+    if (!cycle.empty()) return cycle;
+
+    CsrGraph<Id, Weight> reweighted = csr;
+    for (std::size_t u = 0; u < n; ++u) {
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            if (csr.weights[e] == INF) continue;
+            // floating point rounding may leave -epsilon on tight arcs
+            reweighted.weights[e] = std::max(Weight{0}, csr.weights[e] + p[u] - p[csr.targets[e]]);
+        }
+    }
+
+    struct Scratch {
+        std::optional<DijkstraWorkspace<Id, Weight>> ws;
+        std::vector<Weight> row;
+    };
+    std::vector<Scratch> scratch(pool.size());
+    pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t worker) {
+        Scratch &s = scratch[worker];
+        if (!s.ws) {
+            s.ws.emplace(reweighted);
+            s.row.assign(n, INF);
+        }
+        for (std::size_t src = begin; src < end; ++src) {
+            s.ws->run_until(src, [](std::size_t, Weight) { return false; });
+            for (std::size_t t : s.ws->touched()) s.row[t] = s.ws->distance(csr.ids[t]) - p[src] + p[t];
+            on_row(src, std::span<const Weight>(s.row));
+            for (std::size_t t : s.ws->touched()) s.row[t] = INF;
+        }
+    }, 1);
+    return {};
+}
+
+// Dense n x n result: sources == targets == the graph's nodes (CSR order).
+// The second member holds a negative cycle's ids; the table is empty then.
+template <typename G, typename Extractor>
+auto johnson_apsp(const G &g, Extractor extractor, std::size_t threads = 0) {
+    using Id = typename G::id_type;
+    auto csr = make_csr(g, extractor);
+    using Weight = typename decltype(csr)::weight_type;
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+
+    const std::size_t n = csr.node_count();
+    DistanceTable<Id, Weight> table;
+    table.values.resize(n * n);
+    auto cycle = johnson_apsp_rows(csr, pool, [&](std::size_t s, std::span<const Weight> row) {
+        std::copy(row.begin(), row.end(), table.values.begin() + s * n);
+    });
+
+    std::vector<Id> cycle_ids;
+    for (std::size_t i : cycle) cycle_ids.push_back(csr.ids[i]);
+    if (cycle_ids.empty()) {
+        table.sources = csr.ids;
+        table.targets = csr.ids;
+    } else {
+        table.values.clear();
+    }
+    return std::make_pair(std::move(table), std::move(cycle_ids));
+}
+
+// ------------------ Dense all-pairs (Floyd-Warshall) ------------------
+// SquareMatrix: contiguous row-major n x n storage, entry (i, j) at values[i * n + j].
+template <typename T>
+struct SquareMatrix {
+    std::size_t n = 0;
+    std::vector<T> values;
+
+    SquareMatrix() = default;
+    SquareMatrix(std::size_t size, const T &fill) : n(size), values(size * size, fill) {}
+
+    T &at(std::size_t i, std::size_t j) { return values[i * n + j]; }
+    const T &at(std::size_t i, std::size_t j) const { return values[i * n + j]; }
+    T *row(std::size_t i) { return values.data() + i * n; }
+    const T *row(std::size_t i) const { return values.data() + i * n; }
+    bool empty() const noexcept { return n == 0; }
+};
+
+// Distance matrix of a snapshot: 0 on the diagonal, the lightest arc between
+// two nodes, weight_infinity<Weight>() where there is none.
+template <typename Id, typename Weight>
+SquareMatrix<Weight> adjacency_matrix(const CsrGraph<Id, Weight> &csr) {
+    const std::size_t n = csr.node_count();
+    SquareMatrix<Weight> d(n, weight_infinity<Weight>());
+    for (std::size_t u = 0; u < n; ++u) {
+        d.at(u, u) = Weight{0};
+        for (std::size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            Weight &cell = d.at(u, csr.targets[e]);
+            cell = std::min(cell, csr.weights[e]);
+        }
+    }
+    return d;
+}
+
+// Next-hop matrix matching adjacency_matrix(): next(i, j) = j for every arc,
+// next(i, i) = i, detail::npos elsewhere.
+template <typename Weight>
+SquareMatrix<std::size_t> initial_next_hops(const SquareMatrix<Weight> &d) {
+    SquareMatrix<std::size_t> next(d.n, detail::npos);
+    for (std::size_t i = 0; i < d.n; ++i) {
+        for (std::size_t j = 0; j < d.n; ++j) {
+            if (i == j || d.at(i, j) != weight_infinity<Weight>()) next.at(i, j) = j;
+        }
+    }
+    return next;
+}
+
+namespace detail {
+
+// Min-plus row update c[j] = min(c[j], a + b[j]) for j < len, a finite.
+// b[j] == INF never wins, so integer sums cannot wrap through the sentinel.
+// With AVX2 (e.g. -mavx2 or -march=native) float, double and 32/64-bit signed
+// integers take the vector path; everything else, and the tail, is scalar.
+template <typename Weight>
+inline void min_plus_row(Weight *c, const Weight *b, Weight a, std::size_t len) {
+    const Weight INF = weight_infinity<Weight>();
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<Weight, double>) {
+        const __m256d va = _mm256_set1_pd(a);
+        for (; j + 4 <= len; j += 4) {
+            __m256d s = _mm256_add_pd(va, _mm256_loadu_pd(b + j));
+            _mm256_storeu_pd(c + j, _mm256_min_pd(_mm256_loadu_pd(c + j), s));
+        }
+    } else if constexpr (std::is_same_v<Weight, float>) {
+        const __m256 va = _mm256_set1_ps(a);
+        for (; j + 8 <= len; j += 8) {
+            __m256 s = _mm256_add_ps(va, _mm256_loadu_ps(b + j));
+            _mm256_storeu_ps(c + j, _mm256_min_ps(_mm256_loadu_ps(c + j), s));
+        }
+    } else if constexpr (std::is_integral_v<Weight> && std::is_signed_v<Weight> && sizeof(Weight) == 4) {
+        const __m256i va = _mm256_set1_epi32(static_cast<std::int32_t>(a));
+        const __m256i vinf = _mm256_set1_epi32(static_cast<std::int32_t>(INF));
+        for (; j + 8 <= len; j += 8) {
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+            __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c + j));
+            __m256i m = _mm256_min_epi32(vc, _mm256_add_epi32(va, vb));
+            __m256i is_inf = _mm256_cmpeq_epi32(vb, vinf);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + j), _mm256_blendv_epi8(m, vc, is_inf));
+        }
+    } else if constexpr (std::is_integral_v<Weight> && std::is_signed_v<Weight> && sizeof(Weight) == 8) {
+        const __m256i va = _mm256_set1_epi64x(static_cast<long long>(a));
+        const __m256i vinf = _mm256_set1_epi64x(static_cast<long long>(INF));
+        for (; j + 4 <= len; j += 4) {
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+            __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c + j));
+            __m256i s = _mm256_add_epi64(va, vb);
+            __m256i take = _mm256_andnot_si256(_mm256_cmpeq_epi64(vb, vinf), _mm256_cmpgt_epi64(vc, s));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + j), _mm256_blendv_epi8(vc, s, take));
+        }
+    }
+#endif
+    // branch-free so the compiler can vectorize it where the intrinsics don't apply
+    for (; j < len; ++j) {
+        Weight s = b[j] == INF ? c[j] : a + b[j];
+        c[j] = s < c[j] ? s : c[j];
+    }
+}
+
+// Same update that also records next-hop 'hop' wherever c improves.
+template <typename Weight>
+inline void min_plus_row(Weight *c, const Weight *b, Weight a, std::size_t len, std::size_t *next, std::size_t hop) {
+    const Weight INF = weight_infinity<Weight>();
+    for (std::size_t j = 0; j < len; ++j) {
+        if (b[j] != INF && a + b[j] < c[j]) {
+            c[j] = a + b[j];
+            next[j] = hop;
+        }
+    }
+}
+
+} // namespace detail
+
+// Blocked Floyd-Warshall on d in place (d = adjacency_matrix(...) or any
+// distance matrix with a 0 diagonal). For each diagonal block kb:
+//   1. close the diagonal tile (kb, kb) with plain Floyd-Warshall;
+//   2. update row tiles (kb, *) and column tiles (*, kb), which only read the
+//      diagonal tile - independent, run in parallel;
+//   3. update every other tile (ib, jb) from (ib, kb) and (kb, jb) - all
+//      independent, run in parallel.
+// A block x block tile of three matrices stays in cache, and each inner loop
+// is a contiguous min-plus row update (detail::min_plus_row).
+//
+// Pass 'next' (initial_next_hops(d)) to maintain next hops. Then the classic
+// k-order is kept (rows split across the pool for each k): the blocked order
+// reads (i, k) after later intermediates of the same block, and with
+// zero-weight cycles the next hops it records can loop.
+// Returns true if some d(i, i) < 0, i.e. there is a negative cycle.
+template <typename Weight>
+bool floyd_warshall_inplace(SquareMatrix<Weight> &d,
+                            ThreadPool &pool,
+                            SquareMatrix<std::size_t> *next = nullptr,
+                            std::size_t block = 64)
+{
+    const std::size_t n = d.n;
+    if (n == 0) return false;
+    if (next && next->n != n) throw std::invalid_argument("next-hop matrix size mismatch");
+    if (block == 0) block = 64;
+    const Weight INF = weight_infinity<Weight>();
+    const std::size_t nb = (n + block - 1) / block;
+    auto lo = [&](std::size_t b) { return b * block; };
+    auto hi = [&](std::size_t b) { return std::min(n, (b + 1) * block); };
+
+    auto has_negative_diagonal = [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (d.at(i, i) < Weight{0}) return true;
+        }
+        return false;
+    };
+
+    if (next) {
+        for (std::size_t k = 0; k < n; ++k) {
+            pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const Weight a = d.at(i, k);
+                    if (a == INF || i == k) continue;
+                    detail::min_plus_row(d.row(i), d.row(k), a, n, next->row(i), next->at(i, k));
+                }
+            });
+        }
+        return has_negative_diagonal();
+    }
+
+    // rows [i0, i1) of tile column jb, intermediates k in [k0, k1)
+    auto update = [&](std::size_t i0, std::size_t i1, std::size_t jb, std::size_t k0, std::size_t k1) {
+        const std::size_t j0 = lo(jb), len = hi(jb) - j0;
+        for (std::size_t k = k0; k < k1; ++k) {
+            const Weight *bk = d.row(k) + j0;
+            for (std::size_t i = i0; i < i1; ++i) {
+                const Weight a = d.at(i, k);
+                if (a != INF) detail::min_plus_row(d.row(i) + j0, bk, a, len);
+            }
+        }
+    };
+
+    for (std::size_t kb = 0; kb < nb; ++kb) {
+        const std::size_t k0 = lo(kb), k1 = hi(kb);
+        update(k0, k1, kb, k0, k1);  // phase 1
+
+        // phase 2: tiles 0..nb-1 are row tiles (kb, t), nb..2nb-1 column tiles (t, kb)
+        pool.parallel_for(2 * nb, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t x = begin; x < end; ++x) {
+                std::size_t t = x % nb;
+                if (t == kb) continue;
+                if (x < nb) update(k0, k1, t, k0, k1);
+                else update(lo(t), hi(t), kb, k0, k1);
+            }
+        }, 1);
+
+        // phase 3
+        pool.parallel_for(nb * nb, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t x = begin; x < end; ++x) {
+                std::size_t ib = x / nb, jb = x % nb;
+                if (ib == kb || jb == kb) continue;
+                update(lo(ib), hi(ib), jb, k0, k1);
+            }
+        }, 1);
+    }
+    return has_negative_diagonal();
+}
+
+// Result of floyd_warshall(): distances over the snapshot's node order plus
+// optional next hops for path reconstruction.
+template <typename Id, typename Weight>
+struct AllPairsPaths {
+    std::vector<Id> ids;
+    std::unordered_map<Id, std::size_t> index;
+    SquareMatrix<Weight> dist;
+    SquareMatrix<std::size_t> next;  // empty unless requested
+    bool negative_cycle = false;
+
+    Weight distance(const Id &s, const Id &t) const { return dist.at(index.at(s), index.at(t)); }
+
+    // s .. t following next hops; empty if unreachable, next hops were not
+    // kept, or the walk runs into a negative cycle.
+    std::vector<Id> path(const Id &s, const Id &t) const {
+        std::vector<Id> out;
+        if (next.empty()) return out;
+        std::size_t i = index.at(s);
+        const std::size_t j = index.at(t);
+        if (next.at(i, j) == detail::npos) return out;
+        out.push_back(ids[i]);
+        while (i != j) {
+            i = next.at(i, j);
+            out.push_back(ids[i]);
+            if (out.size() > ids.size()) return {};
+        }
+        return out;
+    }
+};
+
+// Graph wrapper. threads == 0 -> hardware_concurrency().
+template <typename G, typename Extractor>
+auto floyd_warshall(const G &g, Extractor extractor, bool with_next_hops = false, std::size_t threads = 0) {
+    auto csr = make_csr(g, extractor);
+    using Weight = typename decltype(csr)::weight_type;
+    AllPairsPaths<typename G::id_type, Weight> result;
+    result.dist = adjacency_matrix(csr);
+    if (with_next_hops) result.next = initial_next_hops(result.dist);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    result.negative_cycle = floyd_warshall_inplace(result.dist, pool, with_next_hops ? &result.next : nullptr);
+    result.ids = std::move(csr.ids);
+    result.index = std::move(csr.index);
+    return result;
+}
+
+// ------------------ Restricted-intermediate queries ------------------
+// "Shortest s -> t path whose intermediate nodes are among the first 'allowed'
+// nodes of 'order'". Floyd-Warshall after k rounds answers exactly this for
+// the first k nodes, so instead of keeping a matrix per k, queries are sorted
+// by 'allowed' and answered while one n x n matrix (plus next hops when paths
+// are wanted) is swept over 'order'. Same problem as
+// beecrowd/algorithms/bee2130_floydwarshall.cpp in O(n^2) memory.
+template <typename Id>
+struct RestrictedQuery {
+    Id source;
+    Id target;
+    std::size_t allowed;  // number of leading nodes of 'order' usable as intermediates
+};
+
+// Answers in query order. Nodes missing from 'order' are never intermediates;
+// allowed > order.size() means all of 'order'. Assumes no negative cycles.
+template <typename Id, typename Weight>
+std::vector<PathResult<Id, Weight>>
+restricted_intermediate_queries(const CsrGraph<Id, Weight> &csr,
+                                const std::vector<Id> &order,
+                                const std::vector<RestrictedQuery<Id>> &queries,
+                                ThreadPool &pool,
+                                bool with_paths = false)
+{
+    const std::size_t n = csr.node_count();
+    const Weight INF = weight_infinity<Weight>();
+    const auto k_index = detail::indexes_of(csr.index, order);
+    std::vector<std::size_t> s_index(queries.size()), t_index(queries.size());
+    for (std::size_t q = 0; q < queries.size(); ++q) {
+        auto sit = csr.index.find(queries[q].source);
+        auto tit = csr.index.find(queries[q].target);
+        if (sit == csr.index.end() || tit == csr.index.end()) {
+            throw std::invalid_argument("source or target node doesn't exist");
+        }
+        s_index[q] = sit->second;
+        t_index[q] = tit->second;
+    }
+
+    std::vector<std::size_t> by_allowed(queries.size());
+    for (std::size_t q = 0; q < queries.size(); ++q) by_allowed[q] = q;
+    std::stable_sort(by_allowed.begin(), by_allowed.end(), [&](std::size_t a, std::size_t b) {
+        return queries[a].allowed < queries[b].allowed;
+    });
+
+    SquareMatrix<Weight> d = adjacency_matrix(csr);
+    SquareMatrix<std::size_t> next;
+    if (with_paths) next = initial_next_hops(d);
+
+    std::vector<PathResult<Id, Weight>> results(queries.size());
+    auto answer = [&](std::size_t q) {
+        const std::size_t s = s_index[q], t = t_index[q];
+        PathResult<Id, Weight> &r = results[q];
+        r.distance = d.at(s, t);
+        if (!with_paths || r.distance == INF) return;
+        for (std::size_t x = s;; x = next.at(x, t)) {
+            r.path.push_back(csr.ids[x]);
+            if (x == t) break;
+        }
+    };
+
+    std::size_t pending = 0;
+    for (std::size_t step = 0; step <= k_index.size(); ++step) {
+        while (pending < by_allowed.size() &&
+               (queries[by_allowed[pending]].allowed <= step || step == k_index.size())) {
+            answer(by_allowed[pending++]);
+        }
+        if (pending == by_allowed.size() || step == k_index.size()) break;
+
+        const std::size_t k = k_index[step];
+        pool.parallel_for(n, [&](std::size_t begin, std::size_t end, std::size_t) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const Weight a = d.at(i, k);
+                if (a == INF || i == k) continue;
+                if (with_paths) detail::min_plus_row(d.row(i), d.row(k), a, n, next.row(i), next.at(i, k));
+                else detail::min_plus_row(d.row(i), d.row(k), a, n);
+            }
+        });
+    }
+    return results;
+}
+
+// Graph wrapper. threads == 0 -> hardware_concurrency().
+template <typename G, typename Extractor>
+auto restricted_intermediate_queries(const G &g,
+                                     Extractor extractor,
+                                     const std::vector<typename G::id_type> &order,
+                                     const std::vector<RestrictedQuery<typename G::id_type>> &queries,
+                                     bool with_paths = false,
+                                     std::size_t threads = 0)
+{
+    auto csr = make_csr(g, extractor);
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    return restricted_intermediate_queries(csr, order, queries, pool, with_paths);
+}
+
+// ------------------ Min-plus matrix product ------------------
+// Tropical product C(i, j) = min_k A(i, k) + B(k, j) over SquareMatrix, with
+// weight_infinity<Weight>() as the additive identity ("no path"). Tiles of C
+// (block x block) are independent and split across the pool; inside a tile
+// the k dimension is walked in blocks so rows of A and B stay cached, and every
+// inner loop is the vectorized detail::min_plus_row.
+template <typename Weight>
+SquareMatrix<Weight> min_plus_product(const SquareMatrix<Weight> &a,
+                                      const SquareMatrix<Weight> &b,
+                                      ThreadPool &pool,
+                                      std::size_t block = 64)
+{
+    if (a.n != b.n) throw std::invalid_argument("matrix size mismatch");
+    const std::size_t n = a.n;
+    const Weight INF = weight_infinity<Weight>();
+    SquareMatrix<Weight> c(n, INF);
+    if (n == 0) return c;
+    if (block == 0) block = 64;
+    const std::size_t nb = (n + block - 1) / block;
+
+    pool.parallel_for(nb * nb, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t x = begin; x < end; ++x) {
+            const std::size_t i0 = (x / nb) * block, i1 = std::min(n, i0 + block);
+            const std::size_t j0 = (x % nb) * block, len = std::min(n, j0 + block) - j0;
+            for (std::size_t k0 = 0; k0 < n; k0 += block) {
+                const std::size_t k1 = std::min(n, k0 + block);
+                for (std::size_t i = i0; i < i1; ++i) {
+                    Weight *ci = c.row(i) + j0;
+                    const Weight *ai = a.row(i);
+                    for (std::size_t k = k0; k < k1; ++k) {
+                        if (ai[k] != INF) detail::min_plus_row(ci, b.row(k) + j0, ai[k], len);
+                    }
+                }
+            }
+        }
+    }, 1);
+    return c;
+}
+
+// Min-plus identity: 0 on the diagonal, INF elsewhere.
+template <typename Weight>
+SquareMatrix<Weight> min_plus_identity(std::size_t n) {
+    SquareMatrix<Weight> id(n, weight_infinity<Weight>());
+    for (std::size_t i = 0; i < n; ++i) id.at(i, i) = Weight{0};
+    return id;
+}
+
+// base^exp in the min-plus semiring by repeated squaring (the matPow pattern
+// of beecrowd/paradigms/bee1474_onibus.cpp): O(n^3 log exp).
+template <typename Weight>
+SquareMatrix<Weight> min_plus_power(SquareMatrix<Weight> base, std::uint64_t exp, ThreadPool &pool) {
+    SquareMatrix<Weight> res = min_plus_identity<Weight>(base.n);
+    while (exp) {
+        if (exp & 1ULL) res = min_plus_product(res, base, pool);
+        exp >>= 1ULL;
+        if (exp) base = min_plus_product(base, base, pool);
+    }
+    return res;
+}
+
+// Hop-bounded APSP: dist(i, j) = cheapest i -> j path with at most 'hops' arcs.
+// adjacency_matrix() has a 0 diagonal, so its h-th min-plus power covers
+// every path of <= h arcs. Negative arcs are fine, and so are negative cycles
+// (the bound keeps every value finite). next is left empty.
+template <typename G, typename Extractor>
+auto hop_bounded_shortest_paths(const G &g, Extractor extractor, std::uint64_t hops, std::size_t threads = 0) {
+    auto csr = make_csr(g, extractor);
+    using Weight = typename decltype(csr)::weight_type;
+    ThreadPool pool(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    AllPairsPaths<typename G::id_type, Weight> result;
+    result.dist = min_plus_power(adjacency_matrix(csr), hops, pool);
+    for (std::size_t i = 0; i < result.dist.n; ++i) {
+        result.negative_cycle = result.negative_cycle || result.dist.at(i, i) < Weight{0};
+    }
+    result.ids = std::move(csr.ids);
+    result.index = std::move(csr.index);
+    return result;
 }
 
 } // namespace graph_algo
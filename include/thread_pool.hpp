@@ -0,0 +1,128 @@
+#pragma once
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <exception>
+#include <cstddef>
+
+/*
+ * ThreadPool
+ *
+ * Minimal fork-join pool used by the parallel graph algorithms.
+ *  - size() workers in total; the thread calling run()/parallel_for() acts as
+ *    worker 0, so ThreadPool(1) runs everything inline without spawning threads.
+ *  - run(fn) calls fn(worker) once on every worker and returns when all are done.
+ *  - parallel_for(n, fn) hands out [begin, end) chunks of [0, n) dynamically and
+ *    calls fn(begin, end, worker); per-worker scratch can be indexed by 'worker'.
+ *  - An exception thrown by any worker is rethrown from run()/parallel_for().
+ *
+ * Workers sleep between jobs, so one pool can be reused for many phases
+ * (e.g. one per bucket in delta-stepping) without re-creating threads.
+ */
+
+namespace graph_algo {
+
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+        : size_(std::max<std::size_t>(threads, 1))
+    {
+        workers_.reserve(size_ - 1);
+        for (std::size_t w = 1; w < size_; ++w) {
+            workers_.emplace_back([this, w] { worker_loop(w); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t size() const noexcept { return size_; }
+
+    void run(const std::function<void(std::size_t)> &fn) {
+        if (size_ == 1) { fn(0); return; }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            pending_ = size_ - 1;
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        std::exception_ptr local;
+        try { fn(0); } catch (...) { local = std::current_exception(); }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        if (!local) local = error_;
+        if (local) std::rethrow_exception(local);
+    }
+
+    template <typename F>
+    void parallel_for(std::size_t n, F &&fn, std::size_t chunk = 0) {
+        if (n == 0) return;
+        if (chunk == 0) chunk = std::max<std::size_t>(1, n / (size_ * 8));
+        std::atomic<std::size_t> next{0};
+        run([&](std::size_t worker) {
+            while (true) {
+                std::size_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+                if (begin >= n) break;
+                fn(begin, std::min(n, begin + chunk), worker);
+            }
+        });
+    }
+
+private:
+    void worker_loop(std::size_t w) {
+        std::size_t seen = 0;
+        while (true) {
+            const std::function<void(std::size_t)> *job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+            }
+
+            std::exception_ptr err;
+            try { (*job)(w); } catch (...) { err = std::current_exception(); }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (err && !error_) error_ = err;
+            if (--pending_ == 0) done_.notify_one();
+        }
+    }
+
+    std::size_t size_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)> *job_ = nullptr;
+    std::size_t pending_ = 0;
+    std::size_t generation_ = 0;
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+} // namespace graph_algo
+
+#endif // THREAD_POOL_HPP
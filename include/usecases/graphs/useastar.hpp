@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_ASTAR_H
+#define USE_ASTAR_H
+
+void use_astar_and_alt();
+
+#endif // USE_ASTAR_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_BATCH_QUERIES_H
+#define USE_BATCH_QUERIES_H
+
+void use_batch_queries();
+
+#endif // USE_BATCH_QUERIES_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_BIPARTITION_H
+#define USE_BIPARTITION_H
+
+void use_bipartition();
+
+#endif // USE_BIPARTITION_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_CONDENSATION_H
+#define USE_CONDENSATION_H
+
+void use_condensation_and_bridges();
+
+#endif // USE_CONDENSATION_H
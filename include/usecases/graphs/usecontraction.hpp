@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_CONTRACTION_H
+#define USE_CONTRACTION_H
+
+void use_contraction_hierarchy();
+
+#endif // USE_CONTRACTION_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_DAG_PATHS_H
+#define USE_DAG_PATHS_H
+
+void use_dag_paths();
+
+#endif // USE_DAG_PATHS_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_DELTASTEPPING_H
+#define USE_DELTASTEPPING_H
+
+void use_delta_stepping();
+
+#endif // USE_DELTASTEPPING_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_DIAL_H
+#define USE_DIAL_H
+
+void use_dial_and_zero_one_bfs();
+
+#endif // USE_DIAL_H
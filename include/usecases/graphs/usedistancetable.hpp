@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_DISTANCE_TABLE_H
+#define USE_DISTANCE_TABLE_H
+
+void use_distance_table();
+
+#endif // USE_DISTANCE_TABLE_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_FIND_CYCLE_H
+#define USE_FIND_CYCLE_H
+
+void use_find_cycle();
+
+#endif // USE_FIND_CYCLE_H
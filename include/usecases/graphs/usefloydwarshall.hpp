@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_FLOYD_WARSHALL_H
+#define USE_FLOYD_WARSHALL_H
+
+void use_floyd_warshall();
+
+#endif // USE_FLOYD_WARSHALL_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_INCREMENTAL_TOPO_H
+#define USE_INCREMENTAL_TOPO_H
+
+void use_incremental_topological_order();
+
+#endif // USE_INCREMENTAL_TOPO_H
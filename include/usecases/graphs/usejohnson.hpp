@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_JOHNSON_H
+#define USE_JOHNSON_H
+
+void use_johnson_apsp();
+
+#endif // USE_JOHNSON_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_MAXFLOW_DENSE_H
+#define USE_MAXFLOW_DENSE_H
+
+void use_dinic_and_push_relabel();
+
+#endif // USE_MAXFLOW_DENSE_H
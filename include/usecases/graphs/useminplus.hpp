@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_MIN_PLUS_H
+#define USE_MIN_PLUS_H
+
+void use_min_plus_and_hop_bounded();
+
+#endif // USE_MIN_PLUS_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_NEGATIVE_CYCLE_H
+#define USE_NEGATIVE_CYCLE_H
+
+void use_find_negative_cycle();
+
+#endif // USE_NEGATIVE_CYCLE_H
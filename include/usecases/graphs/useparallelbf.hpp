@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_PARALLEL_BF_H
+#define USE_PARALLEL_BF_H
+
+void use_parallel_bellman_ford();
+
+#endif // USE_PARALLEL_BF_H
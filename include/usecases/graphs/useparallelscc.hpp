@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_PARALLEL_SCC_H
+#define USE_PARALLEL_SCC_H
+
+void use_parallel_scc();
+
+#endif // USE_PARALLEL_SCC_H
@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_RESTRICTED_H
+#define USE_RESTRICTED_H
+
+void use_restricted_intermediate_queries();
+
+#endif // USE_RESTRICTED_H
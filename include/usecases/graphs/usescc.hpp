@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_SCC_H
+#define USE_SCC_H
+
+void use_iterative_scc();
+
+#endif // USE_SCC_H
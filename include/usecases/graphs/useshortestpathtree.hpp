@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_SHORTEST_PATH_TREE_H
+#define USE_SHORTEST_PATH_TREE_H
+
+void use_shortest_path_tree();
+
+#endif // USE_SHORTEST_PATH_TREE_H
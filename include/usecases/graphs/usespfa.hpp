@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_SPFA_H
+#define USE_SPFA_H
+
+void use_spfa_and_yen();
+
+#endif // USE_SPFA_H
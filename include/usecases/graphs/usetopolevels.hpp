@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_TOPO_LEVELS_H
+#define USE_TOPO_LEVELS_H
+
+void use_topological_levels();
+
+#endif // USE_TOPO_LEVELS_H
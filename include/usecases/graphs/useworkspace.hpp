@@ -0,0 +1,7 @@
+#pragma once
+#ifndef USE_WORKSPACE_H
+#define USE_WORKSPACE_H
+
+void use_sssp_workspaces();
+
+#endif // USE_WORKSPACE_H
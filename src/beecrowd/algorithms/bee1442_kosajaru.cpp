@@ -23,20 +23,34 @@ void dfs_stack(int s, adjtype& g, vetch& vis) {
     }
 }
 
+// iterative: (vertex, next neighbor position) frames instead of recursion,
+// so long chains don't overflow the call stack
 void kosaraju_dfs1(int u, adjtype& g, vetch& vis, vetint& order) {
+    vector<pair<int,int>> st;
+    st.push_back({u, 0});
     vis[u] = 1;
-    for (int v : g[u])
-        if (!vis[v])
-            kosaraju_dfs1(v, g, vis, order);
-    order.push_back(u);
+    while (!st.empty()) {
+        auto &[x, i] = st.back();
+        if (i < (int)g[x].size()) {
+            int v = g[x][i++];
+            if (!vis[v]) { vis[v] = 1; st.push_back({v, 0}); }
+        } else {
+            order.push_back(x);
+            st.pop_back();
+        }
+    }
 }
 
 void kosaraju_dfs2(int u, adjtype& grev, vetch& vis, vetint& comp, int cid) {
+    stack<int> st;
+    st.push(u);
     vis[u] = 1;
-    comp[u] = cid;
-    for (int v : grev[u])
-        if (!vis[v])
-            kosaraju_dfs2(v, grev, vis, comp, cid);
+    while (!st.empty()) {
+        int x = st.top(); st.pop();
+        comp[x] = cid;
+        for (int v : grev[x])
+            if (!vis[v]) { vis[v] = 1; st.push(v); }
+    }
 }
 
 
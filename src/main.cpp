@@ -21,6 +21,30 @@
 #include "usecases/graphs/usekosaraju.hpp"
 #include "usecases/graphs/usemaxflow.hpp"
 #include "usecases/graphs/usebellmanford.hpp"
+#include "usecases/graphs/usedial.hpp"
+#include "usecases/graphs/useastar.hpp"
+#include "usecases/graphs/usecontraction.hpp"
+#include "usecases/graphs/usedeltastepping.hpp"
+#include "usecases/graphs/useworkspace.hpp"
+#include "usecases/graphs/usedistancetable.hpp"
+#include "usecases/graphs/usebatchqueries.hpp"
+#include "usecases/graphs/usespfa.hpp"
+#include "usecases/graphs/usenegativecycle.hpp"
+#include "usecases/graphs/useparallelbf.hpp"
+#include "usecases/graphs/usejohnson.hpp"
+#include "usecases/graphs/usefloydwarshall.hpp"
+#include "usecases/graphs/userestricted.hpp"
+#include "usecases/graphs/useminplus.hpp"
+#include "usecases/graphs/usedagpaths.hpp"
+#include "usecases/graphs/useshortestpathtree.hpp"
+#include "usecases/graphs/usescc.hpp"
+#include "usecases/graphs/useparallelscc.hpp"
+#include "usecases/graphs/usecondensation.hpp"
+#include "usecases/graphs/useincrementaltopo.hpp"
+#include "usecases/graphs/usefindcycle.hpp"
+#include "usecases/graphs/usetopolevels.hpp"
+#include "usecases/graphs/usebipartition.hpp"
+#include "usecases/graphs/usemaxflowdense.hpp"
 
 using namespace std;
 using namespace graph_algo;
@@ -38,5 +62,29 @@ int main() {
     use_kosaraju_scc();
     use_edmonds_karp_maxflow();
     use_bellman_ford_and_negative_cycle();
+    use_dial_and_zero_one_bfs();
+    use_astar_and_alt();
+    use_contraction_hierarchy();
+    use_delta_stepping();
+    use_sssp_workspaces();
+    use_distance_table();
+    use_batch_queries();
+    use_spfa_and_yen();
+    use_find_negative_cycle();
+    use_parallel_bellman_ford();
+    use_johnson_apsp();
+    use_floyd_warshall();
+    use_restricted_intermediate_queries();
+    use_min_plus_and_hop_bounded();
+    use_dag_paths();
+    use_shortest_path_tree();
+    use_iterative_scc();
+    use_parallel_scc();
+    use_condensation_and_bridges();
+    use_incremental_topological_order();
+    use_find_cycle();
+    use_topological_levels();
+    use_bipartition();
+    use_dinic_and_push_relabel();
     return 0;
 }
@@ -0,0 +1,46 @@
+#include "usecases/graphs/useastar.hpp"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_astar_and_alt() {
+    cout << "*** use_astar_and_alt() ***\n";
+
+    // 20x20 grid, node id = row * 20 + col, unit-length streets
+    const int W = 20;
+    struct Street { double length; };
+    Graph<string,int,Street> grid(false);
+    for (int r=0;r<W;++r) {
+        for (int c=0;c<W;++c) {
+            int id = r*W + c;
+            if (r+1 < W) grid.add_edge(id, id+W, Street{1.0});
+            if (c+1 < W) grid.add_edge(id, id+1, Street{1.0});
+        }
+    }
+    auto length = [](const Street &s)->double { return s.length; };
+
+    int s = 0, t = W*W - 1;
+    // Manhattan distance is admissible on a unit grid
+    auto manhattan = [&](const int &v)->double {
+        return abs(v / W - t / W) + abs(v % W - t % W);
+    };
+
+    auto plain = shortest_path(grid, s, t, length);
+    auto geo = astar(grid, s, t, length, manhattan);
+    auto alt = make_alt_heuristic(grid, length, 4);
+    auto landmark = astar(grid, s, t, length, alt.to(t));
+
+    cout << "Dijkstra : dist " << plain.distance << ", settled " << plain.settled << "\n";
+    cout << "A* (L1)  : dist " << geo.distance << ", settled " << geo.settled << "\n";
+    cout << "A* (ALT) : dist " << landmark.distance << ", settled " << landmark.settled
+         << " using landmarks: ";
+    for (auto id : alt.landmarks()) cout << id << " ";
+    cout << "\n\n";
+}
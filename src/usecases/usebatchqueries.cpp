@@ -0,0 +1,76 @@
+#include "usecases/graphs/usebatchqueries.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_batch_queries() {
+    cout << "*** use_batch_queries() ***\n";
+
+    // small road network: 1 -> 2 -> 3 -> 4, plus a detour 1 -> 5 -> 4
+    Graph<string,int,int> roads(true);
+    roads.add_edge(1, 2, 4);
+    roads.add_edge(2, 3, 1);
+    roads.add_edge(3, 4, 2);
+    roads.add_edge(1, 5, 3);
+    roads.add_edge(5, 4, 5);
+    auto km = [](const int &w)->int { return w; };
+
+    vector<pair<int,int>> requests = {{1, 4}, {2, 4}, {1, 3}, {1, 4}, {4, 1}};
+    auto answers = batch_shortest_paths(roads, requests, km, 2);
+    for (size_t i=0;i<requests.size();++i) {
+        cout << requests[i].first << " -> " << requests[i].second << ": ";
+        if (!answers[i].reachable()) { cout << "unreachable\n"; continue; }
+        cout << answers[i].distance << " via";
+        for (int v : answers[i].path) cout << " " << v;
+        cout << "\n";
+    }
+
+    // gateway-style burst: 2000 requests from 20 hubs on a 100x100 grid
+    const int W = 100;
+    Graph<int,int,double> grid(false);
+    for (int r=0;r<W;++r) {
+        for (int c=0;c<W;++c) {
+            int id = r*W + c;
+            if (r+1 < W) grid.add_edge(id, id+W, 1.0 + (id % 7));
+            if (c+1 < W) grid.add_edge(id, id+1, 1.0 + (id % 5));
+        }
+    }
+    auto identity = [](const double &w)->double { return w; };
+    auto csr = make_csr(grid, identity);
+
+    mt19937 rng(5);
+    uniform_int_distribution<int> pick(0, W*W - 1);
+    vector<int> hubs;
+    for (int i=0;i<20;++i) hubs.push_back(pick(rng));
+    vector<pair<int,int>> burst;
+    for (int i=0;i<2000;++i) {
+        int s = hubs[i % hubs.size()];
+        burst.push_back({s, min(W*W - 1, s + (i % 9) * W + (i % 11))});
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    DijkstraWorkspace<int,double> ws(csr);
+    double one_by_one = 0;
+    for (auto [s, t] : burst) one_by_one += ws.run(s, t).distance;
+    auto t1 = chrono::steady_clock::now();
+
+    ThreadPool pool(4);
+    BatchQueryEngine<int,double> engine(csr, pool);
+    for (auto [s, t] : burst) engine.submit(s, t);
+    auto results = engine.run(false);
+    auto t2 = chrono::steady_clock::now();
+    double batched = 0;
+    for (const auto &r : results) batched += r.distance;
+
+    cout << "2000 queries, one search each : " << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    cout << "2000 queries, BatchQueryEngine: " << chrono::duration<double, milli>(t2 - t1).count() << " ms"
+         << (one_by_one == batched ? "" : " MISMATCH") << "\n\n";
+}
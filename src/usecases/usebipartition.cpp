@@ -0,0 +1,63 @@
+#include "usecases/graphs/usebipartition.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_bipartition() {
+    cout << "*** use_bipartition() ***\n";
+
+    // exam scheduling: an edge means two courses share a student; two rooms/slots
+    Graph<int,string,int> clash(false);
+    for (string c : {"Calculo", "Algebra", "Fisica", "Grafos", "Redes", "Compiladores"}) clash.add_node(c, 0);
+    clash.add_edge("Calculo", "Grafos"); clash.add_edge("Calculo", "Redes");
+    clash.add_edge("Algebra", "Grafos"); clash.add_edge("Fisica", "Redes");
+    clash.add_edge("Fisica", "Compiladores"); clash.add_edge("Algebra", "Compiladores");
+
+    auto print = [](const Bipartition<string> &r) {
+        if (!r.bipartite) {
+            cout << "odd cycle:";
+            for (const auto &id : r.odd_cycle) cout << " " << id;
+            cout << "\n";
+            return;
+        }
+        cout << "slot A:";
+        for (const auto &id : r.left) cout << " " << id;
+        cout << " | slot B:";
+        for (const auto &id : r.right) cout << " " << id;
+        cout << "\n";
+    };
+    print(bipartition(clash));
+    clash.add_edge("Grafos", "Compiladores");
+    cout << "after Grafos - Compiladores: ";
+    print(bipartition(clash));
+
+    // 1000x1000 grid with one diagonal near the far corner
+    const int side = 1000;
+    Graph<int,int,int> grid(false);
+    for (int i = 0; i < side * side; ++i) grid.add_node(i, 0);
+    for (int r = 0; r < side; ++r)
+        for (int c = 0; c < side; ++c) {
+            if (c + 1 < side) grid.add_edge(r * side + c, r * side + c + 1);
+            if (r + 1 < side) grid.add_edge(r * side + c, (r + 1) * side + c);
+        }
+    grid.add_edge(side * side - 1 - side, side * side - 2);
+
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    auto t0 = chrono::steady_clock::now();
+    bool ok = is_bipartite(grid);
+    auto t1 = chrono::steady_clock::now();
+    auto seq = bipartition(grid);
+    auto t2 = chrono::steady_clock::now();
+    auto par = bipartition_parallel(grid, 4);
+    auto t3 = chrono::steady_clock::now();
+    cout << side * side << "-node grid bipartite? " << (ok ? "YES" : "NO") << " in " << ms(t0, t1) << " ms\n";
+    cout << "bipartition         : odd cycle of " << seq.odd_cycle.size() - 1 << " edges in " << ms(t1, t2) << " ms\n";
+    cout << "bipartition_parallel: odd cycle of " << par.odd_cycle.size() - 1 << " edges in " << ms(t2, t3) << " ms\n\n";
+}
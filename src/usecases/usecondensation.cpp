@@ -0,0 +1,62 @@
+#include "usecases/graphs/usecondensation.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_condensation_and_bridges() {
+    cout << "*** use_condensation_and_bridges() ***\n";
+
+    // bee1442 question on a small city: which one-way street would have to become
+    // two-way? Two-way blocks collapse into SCCs; a condensation arc that is a
+    // bridge and carries a single street is the answer.
+    Graph<string,string,int> city(true);
+    auto two_way = [&](const string &a, const string &b) { city.add_edge(a, b); city.add_edge(b, a); };
+    two_way("Centro", "Savassi"); two_way("Savassi", "Funcionarios");
+    two_way("Pampulha", "Liberdade");
+    city.add_edge("Funcionarios", "Pampulha");     // two one-way streets into the north
+    city.add_edge("Savassi", "Liberdade");
+    city.add_edge("Pampulha", "Venda Nova");       // the only way to Venda Nova
+    city.add_edge("Centro", "Barreiro");           // two ways to Barreiro
+    city.add_edge("Savassi", "Barreiro");
+
+    auto cond = condensation(city);
+    auto members = cond.members();
+    auto blocks = biconnectivity_dense(cond.dag, false);
+    cout << cond.size() << " SCCs:";
+    for (size_t c = 0; c < cond.size(); ++c) {
+        cout << " " << c << "{";
+        for (const auto &id : members[c]) cout << " " << id;
+        cout << " }";
+    }
+    cout << "\n";
+    for (size_t e = 0; e < blocks.edges.size(); ++e) {
+        if (!blocks.is_bridge[e]) continue;
+        auto [a, b] = blocks.edges[e];
+        cout << "bridge " << a << " -> " << b << " carries " << cond.dag.weights[e] << " street(s)\n";
+    }
+
+    // undirected view of the same map
+    Graph<string,string,int> roads(false);
+    for (const auto &[u, v, w] : city.list_edges()) roads.add_edge(u, v, w);
+    cout << "articulation points:";
+    for (const auto &id : articulation_points(roads)) cout << " " << id;
+    cout << "\nblocks: " << biconnected_components(roads).size() << "\n";
+
+    // long road: 1000000 nodes in a line, the recursive DFS would overflow here
+    const int N = 1000000;
+    Graph<string,int,int> line(false);
+    for (int i=0;i+1<N;++i) line.add_edge(i, i + 1);
+    auto t0 = chrono::steady_clock::now();
+    auto br = bridges(line);
+    auto t1 = chrono::steady_clock::now();
+    cout << N << "-node path: " << br.size() << " bridges in "
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms\n\n";
+}
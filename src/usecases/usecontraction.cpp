@@ -0,0 +1,48 @@
+#include "usecases/graphs/usecontraction.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_contraction_hierarchy() {
+    cout << "*** use_contraction_hierarchy() ***\n";
+
+    // 30x30 road grid with varying segment lengths
+    const int W = 30;
+    struct Road { int meters; };
+    Graph<string,int,Road> city(false);
+    for (int r=0;r<W;++r) {
+        for (int c=0;c<W;++c) {
+            int id = r*W + c;
+            if (r+1 < W) city.add_edge(id, id+W, Road{100 + (id * 37) % 50});
+            if (c+1 < W) city.add_edge(id, id+1, Road{100 + (id * 53) % 50});
+        }
+    }
+    auto meters = [](const Road &r)->int { return r.meters; };
+
+    // offline: contract once, store the index
+    auto ch = build_contraction_hierarchy(city, meters);
+    cout << "Contracted " << ch.node_count() << " nodes, " << ch.arc_count()
+         << " arcs (" << ch.shortcut_count() << " shortcuts)\n";
+
+    stringstream index_file;
+    ch.save(index_file);
+    auto loaded = ContractionHierarchy<int,int>::load(index_file);
+
+    // online: many queries against the same index, one ChQuery per thread
+    ChQuery<int,int> query(loaded);
+    for (auto [s, t] : {pair{0, W*W-1}, pair{W-1, W*(W-1)}, pair{5*W+3, 17*W+21}}) {
+        auto viaCh = query.run(s, t);
+        auto viaDijkstra = shortest_path(city, s, t, meters);
+        cout << s << " -> " << t << ": CH " << viaCh.distance << " (settled " << viaCh.settled
+             << "), Dijkstra " << viaDijkstra.distance << " (settled " << viaDijkstra.settled
+             << "), path hops " << viaCh.path.size() - 1 << "\n";
+    }
+    cout << "\n";
+}
@@ -0,0 +1,68 @@
+#include "usecases/graphs/usedagpaths.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_dag_paths() {
+    cout << "*** use_dag_paths() ***\n";
+
+    // build pipeline: arc u -> v weighted by how long u takes before v can start
+    Graph<string,string,int> build(true);
+    build.add_edge("fetch", "configure", 2);
+    build.add_edge("configure", "compile", 1);
+    build.add_edge("configure", "docs", 1);
+    build.add_edge("compile", "test", 9);
+    build.add_edge("compile", "package", 9);
+    build.add_edge("docs", "package", 4);
+    build.add_edge("test", "release", 6);
+    build.add_edge("package", "release", 3);
+    auto secs = [](const int &w)->int { return w; };
+
+    auto cp = critical_path(build, secs);
+    cout << "critical path (" << cp.length << "s):";
+    for (const auto &id : cp.path) cout << " " << id;
+    cout << "\nslack:";
+    for (const auto &id : {"docs", "package", "test"}) cout << " " << id << "=" << cp.slack(id);
+    cout << "\n";
+
+    // negative arcs are fine on a DAG: credits for cached steps
+    build.add_edge("fetch", "compile", -1);
+    auto [dist, prev] = dag_shortest_paths(build, string("fetch"), secs);
+    cout << "shortest fetch -> release: " << dist["release"] << " via";
+    for (const auto &id : reconstruct_path<Graph<string,string,int>>(prev, "release")) cout << " " << id;
+    cout << "\n";
+
+    // 200 queries on a 20000-node layered DAG: dijkstra vs cached DagPaths
+    const int N = 20000;
+    mt19937 rng(41);
+    Graph<int,int,int> dag(true);
+    for (int i=0;i<N;++i) dag.add_node(i, i);
+    for (int i=0;i<N;++i)
+        for (int k=0;k<4;++k) {
+            int j = i + 1 + (int)(rng() % 50);
+            if (j < N) dag.add_edge(i, j, 1 + (int)(rng() % 100));
+        }
+    auto w = [](const int &x)->int { return x; };
+
+    auto t0 = chrono::steady_clock::now();
+    long check1 = 0;
+    for (int q=0;q<200;++q) { auto [d, p] = dijkstra(dag, q * 7, w); check1 += d[N - 1]; }
+    auto t1 = chrono::steady_clock::now();
+    DagPaths paths(dag, w);
+    long check2 = 0;
+    for (int q=0;q<200;++q) { auto [d, p] = paths.shortest_paths(q * 7); check2 += d[N - 1]; }
+    auto t2 = chrono::steady_clock::now();
+
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << "200 queries, dijkstra         : " << ms(t0, t1) << " ms\n";
+    cout << "200 queries, DagPaths (cached): " << ms(t1, t2) << " ms"
+         << (check1 == check2 ? "" : " MISMATCH") << "\n\n";
+}
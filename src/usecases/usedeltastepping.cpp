@@ -0,0 +1,47 @@
+#include "usecases/graphs/usedeltastepping.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_delta_stepping() {
+    cout << "*** use_delta_stepping() ***\n";
+
+    // random sparse digraph: 50k nodes, 250k edges, weights in [0, 1)
+    const int n = 50000, m = 250000;
+    mt19937 rng(42);
+    uniform_int_distribution<int> node(0, n-1);
+    uniform_real_distribution<double> weight(0.0, 1.0);
+    Graph<int,int,double> g(true);
+    for (int i=0;i<n;++i) g.add_node(i, i);
+    for (int i=0;i<m;++i) g.add_edge(node(rng), node(rng), weight(rng));
+
+    auto identity = [](const double &w)->double { return w; };
+    auto csr = make_csr(g, identity);
+    cout << "suggested delta: " << suggest_delta(csr) << "\n";
+
+    auto t0 = chrono::steady_clock::now();
+    auto reference = dijkstra_dense(csr, 0).first;
+    auto t1 = chrono::steady_clock::now();
+    cout << fixed << setprecision(2);
+    cout << "dijkstra         : " << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        ThreadPool pool(threads);
+        auto start = chrono::steady_clock::now();
+        auto dist = delta_stepping_dense(csr, 0, pool).first;
+        auto stop = chrono::steady_clock::now();
+        cout << "delta-stepping x" << setw(2) << threads << ": "
+             << chrono::duration<double, milli>(stop - start).count() << " ms"
+             << (dist == reference ? "" : " (MISMATCH)") << "\n";
+    }
+    cout << defaultfloat << setprecision(6) << "\n";
+}
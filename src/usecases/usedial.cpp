@@ -0,0 +1,44 @@
+#include "usecases/graphs/usedial.hpp"
+#include <iostream>
+#include <string>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_dial_and_zero_one_bfs() {
+    cout << "*** use_dial_and_zero_one_bfs() ***\n";
+
+    // Small integer weights (minutes between stops, at most 10)
+    struct Trip { int minutes; };
+    Graph<string,int,Trip> g(true);
+    for (int i=1;i<=5;++i) g.add_node(i,"S"+to_string(i));
+    g.add_edge(1,2,Trip{4}); g.add_edge(1,3,Trip{1});
+    g.add_edge(3,2,Trip{2}); g.add_edge(2,4,Trip{5});
+    g.add_edge(3,4,Trip{10}); g.add_edge(4,5,Trip{3});
+
+    auto minutes = [](const Trip &t)->int { return t.minutes; };
+
+    // bounded_weight() declares the upper bound -> dijkstra() runs Dial's buckets
+    auto [dist, prev] = dijkstra(g, 1, bounded_weight(minutes, 10));
+    cout << "Dial distances from 1:\n";
+    for (int id=1; id<=5; ++id) {
+        if (dist[id] == weight_infinity<int>()) cout << id << ": unreachable\n";
+        else cout << id << ": " << dist[id] << "\n";
+    }
+    cout << "Path 1 -> 5: ";
+    for (auto id : reconstruct_path<Graph<string,int,Trip>>(prev, 5)) cout << id << " ";
+    cout << "\n";
+
+    // {0,1} weights (1 = toll road, 0 = free road) -> 0-1 BFS
+    Graph<string,int,int> tolls(false);
+    for (int i=1;i<=4;++i) tolls.add_node(i,"C"+to_string(i));
+    tolls.add_edge(1,2,1); tolls.add_edge(2,3,0);
+    tolls.add_edge(1,3,1); tolls.add_edge(3,4,0);
+    auto toll = [](const int &t)->int { return t; };
+    auto [tdist, tprev] = dijkstra(tolls, 1, bounded_weight(toll, 1));
+    cout << "Toll roads needed from 1 to 4: " << tdist[4] << "\n\n";
+}
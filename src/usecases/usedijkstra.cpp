@@ -106,5 +106,15 @@ void use_disjktra() {
         cout << "\nDistance: " << distances[target] << "\n";
     }
 
+    // Point-to-point queries: stop once the target is settled
+    auto p2p = graph_algo::shortest_path(g4, 1, target, extractor2);
+    auto bidir = graph_algo::bidirectional_dijkstra(g4, 1, target, extractor2);
+    cout << "shortest_path 1 -> " << target << ": " << p2p.distance
+         << " (settled " << p2p.settled << " of " << g4.node_count() << " nodes)\n";
+    cout << "bidirectional 1 -> " << target << ": " << bidir.distance
+         << " (settled " << bidir.settled << " nodes), path: ";
+    for (auto id : bidir.path) cout << id << " ";
+    cout << "\n";
+
     cout << "\nMermaid syntax:\n" << g4.to_mermaid() << "\n";
 }
\ No newline at end of file
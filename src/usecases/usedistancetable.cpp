@@ -0,0 +1,63 @@
+#include "usecases/graphs/usedistancetable.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_distance_table() {
+    cout << "*** use_distance_table() ***\n";
+
+    // 60x60 grid, 40 depots x 40 customers
+    const int W = 60;
+    Graph<int,int,double> grid(false);
+    for (int r=0;r<W;++r) {
+        for (int c=0;c<W;++c) {
+            int id = r*W + c;
+            if (r+1 < W) grid.add_edge(id, id+W, 1.0 + (id % 7));
+            if (c+1 < W) grid.add_edge(id, id+1, 1.0 + (id % 5));
+        }
+    }
+    auto identity = [](const double &w)->double { return w; };
+    auto csr = make_csr(grid, identity);
+
+    mt19937 rng(11);
+    uniform_int_distribution<int> pick(0, W*W - 1);
+    vector<int> depots, customers;
+    for (int i=0;i<40;++i) depots.push_back(pick(rng));
+    for (int i=0;i<40;++i) customers.push_back(pick(rng));
+
+    auto t0 = chrono::steady_clock::now();
+    vector<double> naive;
+    for (int s : depots) {
+        auto dist = dijkstra_with_extractor<Graph<int,int,double>, double>(grid, s, identity).first;
+        for (int t : customers) naive.push_back(dist[t]);
+    }
+    auto t1 = chrono::steady_clock::now();
+
+    ThreadPool pool(4);
+    auto table = distance_table(csr, depots, customers, pool);
+    auto t2 = chrono::steady_clock::now();
+
+    auto ch = ContractionHierarchy<int,double>::build(csr);
+    auto t3 = chrono::steady_clock::now();
+    auto ch_table = distance_table(ch, depots, customers, pool);
+    auto t4 = chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return chrono::duration<double, milli>(b - a).count(); };
+    cout << "40x40 table, dijkstra per depot   : " << ms(t0, t1) << " ms\n";
+    cout << "40x40 table, distance_table (csr) : " << ms(t1, t2) << " ms"
+         << (table.values == naive ? "" : " MISMATCH") << "\n";
+    cout << "40x40 table, distance_table (ch)  : " << ms(t3, t4) << " ms"
+         << " (+" << ms(t2, t3) << " ms preprocessing)"
+         << (ch_table.values == naive ? "" : " MISMATCH") << "\n";
+    cout << "depot " << depots[0] << " -> customers:";
+    for (size_t j=0;j<5;++j) cout << " " << table.at(0, j);
+    cout << " ...\n\n";
+}
@@ -0,0 +1,48 @@
+#include "usecases/graphs/usefindcycle.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_find_cycle() {
+    cout << "*** use_find_cycle() ***\n";
+
+    auto show = [](const auto &cycle) {
+        if (cycle.empty()) { cout << "none\n"; return; }
+        for (const auto &id : cycle) cout << id << " ";
+        cout << "\n";
+    };
+
+    Graph<string,string,int> imports(true);
+    imports.add_edge("app", "ui"); imports.add_edge("ui", "widgets");
+    imports.add_edge("widgets", "theme"); imports.add_edge("theme", "ui");
+    imports.add_edge("app", "net");
+    cout << "import cycle: "; show(find_cycle(imports));
+
+    Graph<string,string,int> pipes(false);
+    pipes.add_edge("A", "B"); pipes.add_edge("B", "C"); pipes.add_edge("C", "D");
+    pipes.add_edge("B", "E");
+    cout << "pipe network loop: "; show(find_cycle(pipes));
+    pipes.add_edge("D", "E");
+    cout << "after D - E      : "; show(find_cycle(pipes));
+
+    // 1000000-node dependency chain: the recursive version overflowed the stack
+    const int N = 1000000;
+    Graph<string,int,int> chain(true);
+    for (int i=0;i+1<N;++i) chain.add_edge(i, i + 1);
+    auto t0 = chrono::steady_clock::now();
+    bool acyclic = is_acyclic(chain);
+    auto t1 = chrono::steady_clock::now();
+    chain.add_edge(N - 1, 0);
+    auto cycle = find_cycle(chain);
+    auto t2 = chrono::steady_clock::now();
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << N << "-node chain acyclic? " << (acyclic ? "YES" : "NO") << " in " << ms(t0, t1) << " ms\n";
+    cout << "closed chain: cycle of " << cycle.size() - 1 << " nodes in " << ms(t1, t2) << " ms\n\n";
+}
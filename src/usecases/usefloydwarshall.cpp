@@ -0,0 +1,65 @@
+#include "usecases/graphs/usefloydwarshall.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_floyd_warshall() {
+    cout << "*** use_floyd_warshall() ***\n";
+
+    Graph<string,string,int> city(true);
+    city.add_edge("A", "B", 4);
+    city.add_edge("B", "C", -2);
+    city.add_edge("A", "C", 5);
+    city.add_edge("C", "D", 3);
+    city.add_edge("D", "A", 1);
+    auto identity = [](const int &w)->int { return w; };
+    auto apsp = floyd_warshall(city, identity, true, 2);
+    cout << "A -> D: " << apsp.distance("A", "D") << " via";
+    for (const auto &v : apsp.path("A", "D")) cout << " " << v;
+    cout << "\nD -> C: " << apsp.distance("D", "C") << " via";
+    for (const auto &v : apsp.path("D", "C")) cout << " " << v;
+    cout << "\n";
+
+    // dense random graph: vector<vector<long>> triple loop vs blocked kernel
+    const size_t N = 600;
+    mt19937 rng(37);
+    SquareMatrix<long> d(N, weight_infinity<long>());
+    for (size_t i=0;i<N;++i) {
+        d.at(i, i) = 0;
+        for (size_t k=0;k<N/10;++k) d.at(i, rng() % N) = 1 + rng() % 1000;
+        d.at(i, i) = 0;
+    }
+    vector<vector<long>> naive(N, vector<long>(N));
+    for (size_t i=0;i<N;++i) for (size_t j=0;j<N;++j) naive[i][j] = d.at(i, j);
+
+    auto t0 = chrono::steady_clock::now();
+    const long INF = weight_infinity<long>();
+    for (size_t k=0;k<N;++k)
+        for (size_t i=0;i<N;++i)
+            for (size_t j=0;j<N;++j)
+                if (naive[i][k] != INF && naive[k][j] != INF && naive[i][k] + naive[k][j] < naive[i][j])
+                    naive[i][j] = naive[i][k] + naive[k][j];
+    auto t1 = chrono::steady_clock::now();
+    ThreadPool pool(thread::hardware_concurrency());
+    floyd_warshall_inplace(d, pool);
+    auto t2 = chrono::steady_clock::now();
+
+    bool same = true;
+    for (size_t i=0;i<N;++i) for (size_t j=0;j<N;++j) same = same && naive[i][j] == d.at(i, j);
+    auto ms = [](auto a, auto b) { return chrono::duration<double, milli>(b - a).count(); };
+    cout << N << "x" << N << " triple loop     : " << ms(t0, t1) << " ms\n";
+    cout << N << "x" << N << " blocked (64x64) : " << ms(t1, t2) << " ms"
+#if defined(__AVX2__)
+         << " [AVX2]"
+#endif
+         << (same ? "" : " MISMATCH") << "\n\n";
+}
@@ -0,0 +1,65 @@
+#include "usecases/graphs/usemaxflowdense.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <random>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_dinic_and_push_relabel() {
+    cout << "*** use_dinic_and_push_relabel() ***\n";
+
+    // interns -> projects they can join -> each project takes up to 2 interns
+    Graph<int,string,int> staff(true);
+    auto cap = [](int c) { return c; };
+    for (string p : {"Ana", "Bruno", "Carla", "Davi", "Elisa"}) staff.add_edge("src", p, 1);
+    staff.add_edge("Ana", "compiler", 1); staff.add_edge("Ana", "web", 1);
+    staff.add_edge("Bruno", "compiler", 1);
+    staff.add_edge("Carla", "compiler", 1); staff.add_edge("Carla", "db", 1);
+    staff.add_edge("Davi", "compiler", 1);
+    staff.add_edge("Elisa", "web", 1); staff.add_edge("Elisa", "db", 1);
+    for (string p : {"compiler", "web", "db"}) staff.add_edge(p, "sink", 2);
+
+    auto net = make_flow_network(staff, cap);
+    const size_t s = net.index.at("src"), t = net.index.at("sink");
+    cout << "interns placed: dinic " << dinic_dense(net, s, t);
+    for (size_t u = 0; u < net.node_count(); ++u)
+        for (size_t a = net.offsets[u]; a < net.offsets[u + 1]; ++a)
+            if (net.flow(a) > 0 && net.ids[u] != "src" && net.ids[net.head[a]] != "sink")
+                cout << " " << net.ids[u] << "->" << net.ids[net.head[a]];
+    net.reset();
+    cout << " | push-relabel " << push_relabel_dense(net, s, t)
+         << " | edmonds-karp " << edmonds_karp_maxflow(staff, "src", "sink", cap) << "\n";
+
+    // 100x100 grid, left column -> right column, random capacities
+    const int side = 100;
+    Graph<int,int,int> grid(true);
+    mt19937 rng(50);
+    for (int r = 0; r < side; ++r)
+        for (int c = 0; c < side; ++c) {
+            int v = r * side + c;
+            if (c + 1 < side) grid.add_edge(v, v + 1, 1 + rng() % 100);
+            if (r + 1 < side) { grid.add_edge(v, v + side, 1 + rng() % 100); grid.add_edge(v + side, v, 1 + rng() % 100); }
+        }
+    const int source = side * side, sink = source + 1;
+    for (int r = 0; r < side; ++r) { grid.add_edge(source, r * side, 1000); grid.add_edge(r * side + side - 1, sink, 1000); }
+
+    auto grid_net = make_flow_network(grid, cap);
+    const size_t gs = grid_net.index.at(source), gt = grid_net.index.at(sink);
+    auto time = [&](const char *name, auto run) {
+        grid_net.reset();
+        auto t0 = chrono::steady_clock::now();
+        int flow = run(grid_net, gs, gt);
+        auto t1 = chrono::steady_clock::now();
+        cout << name << flow << " in " << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    };
+    time("edmonds_karp_dense: ", [](auto &n, size_t a, size_t b) { return edmonds_karp_dense(n, a, b); });
+    time("dinic_dense       : ", [](auto &n, size_t a, size_t b) { return dinic_dense(n, a, b); });
+    time("push_relabel_dense: ", [](auto &n, size_t a, size_t b) { return push_relabel_dense(n, a, b); });
+    cout << "\n";
+}
@@ -0,0 +1,63 @@
+#include "usecases/graphs/useminplus.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_min_plus_and_hop_bounded() {
+    cout << "*** use_min_plus_and_hop_bounded() ***\n";
+
+    // flights: cheapest fare with at most h legs
+    Graph<string,string,int> flights(true);
+    flights.add_edge("GRU", "LIS", 900);
+    flights.add_edge("LIS", "FRA", 120);
+    flights.add_edge("FRA", "TYO", 700);
+    flights.add_edge("GRU", "FRA", 1300);
+    flights.add_edge("GRU", "TYO", 2600);
+    auto fare = [](const int &w)->int { return w; };
+    for (uint64_t legs : {0, 1, 2, 3}) {
+        auto apsp = hop_bounded_shortest_paths(flights, fare, legs, 2);
+        int d = apsp.distance("GRU", "TYO");
+        cout << "GRU -> TYO with <= " << legs << " legs: ";
+        if (d == weight_infinity<int>()) cout << "none\n";
+        else cout << d << "\n";
+    }
+
+    // 300x300 product: naive i-j-k loops on vector<vector<long>> vs tiled kernel
+    const size_t N = 300;
+    const long INF = weight_infinity<long>();
+    mt19937 rng(47);
+    SquareMatrix<long> a(N, INF), b(N, INF);
+    for (auto &v : a.values) if (rng() % 4 == 0) v = rng() % 1000;
+    for (auto &v : b.values) if (rng() % 4 == 0) v = rng() % 1000;
+    vector<vector<long>> na(N, vector<long>(N)), nb(N, vector<long>(N)), nc(N, vector<long>(N, INF));
+    for (size_t i=0;i<N;++i) for (size_t j=0;j<N;++j) { na[i][j] = a.at(i, j); nb[i][j] = b.at(i, j); }
+
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i=0;i<N;++i)
+        for (size_t j=0;j<N;++j)
+            for (size_t k=0;k<N;++k)
+                if (na[i][k] != INF && nb[k][j] != INF) nc[i][j] = min(nc[i][j], na[i][k] + nb[k][j]);
+    auto t1 = chrono::steady_clock::now();
+    ThreadPool pool(thread::hardware_concurrency());
+    auto c = min_plus_product(a, b, pool);
+    auto t2 = chrono::steady_clock::now();
+
+    bool same = true;
+    for (size_t i=0;i<N;++i) for (size_t j=0;j<N;++j) same = same && nc[i][j] == c.at(i, j);
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << N << "x" << N << " min-plus, naive loops : " << ms(t0, t1) << " ms\n";
+    cout << N << "x" << N << " min-plus, tiled kernel: " << ms(t1, t2) << " ms"
+#if defined(__AVX2__)
+         << " [AVX2]"
+#endif
+         << (same ? "" : " MISMATCH") << "\n\n";
+}
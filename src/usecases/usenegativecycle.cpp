@@ -0,0 +1,59 @@
+#include "usecases/graphs/usenegativecycle.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_find_negative_cycle() {
+    cout << "*** use_find_negative_cycle() ***\n";
+
+    // arbitrage: weight = -log(rate), a cycle with product of rates > 1 is negative
+    Graph<string,string,double> fx(true);
+    auto rate = [&](const string &a, const string &b, double r) { fx.add_edge(a, b, -log(r)); };
+    rate("USD", "EUR", 0.92);
+    rate("EUR", "GBP", 0.86);
+    rate("GBP", "USD", 1.28);  // 0.92 * 0.86 * 1.28 = 1.0127
+    rate("USD", "JPY", 150.0);
+    rate("JPY", "EUR", 0.0061);
+    auto identity = [](const double &w)->double { return w; };
+
+    auto cycle = find_negative_cycle(fx, identity);
+    cout << "arbitrage cycle:";
+    for (const auto &c : cycle) cout << " " << c;
+    if (!cycle.empty()) cout << " " << cycle.front();
+    cout << "\n";
+
+    // 100k nodes, 400k arcs, non-negative except one planted cycle
+    const int N = 100000;
+    Graph<int,int,long> big(true);
+    mt19937 rng(23);
+    for (int i=0;i<N;++i) big.add_node(i, 0);
+    for (int i=0;i<4*N;++i) {
+        int u = rng() % N, v = rng() % N;
+        if (u != v) big.add_edge(u, v, 1 + rng() % 1000);
+    }
+    auto w = [](const long &x)->long { return x; };
+
+    auto t0 = chrono::steady_clock::now();
+    bool before = has_negative_cycle(big, w);
+    auto t1 = chrono::steady_clock::now();
+    big.add_edge(10, 20, -5);
+    big.add_edge(20, 30, -5);
+    big.add_edge(30, 10, 9);
+    auto planted = find_negative_cycle(big, w);
+    auto t2 = chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return chrono::duration<double, milli>(b - a).count(); };
+    cout << N << " nodes, no cycle  : " << (before ? "YES" : "NO") << " in " << ms(t0, t1) << " ms\n";
+    cout << N << " nodes, planted   :";
+    for (int v : planted) cout << " " << v;
+    cout << " in " << ms(t1, t2) << " ms\n\n";
+}
@@ -0,0 +1,51 @@
+#include "usecases/graphs/useparallelbf.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_parallel_bellman_ford() {
+    cout << "*** use_parallel_bellman_ford() ***\n";
+
+    // 1000 nodes, ~20 arcs per node. w = base + p[u] - p[v] with base >= 0:
+    // many negative arcs, but every cycle has non-negative weight
+    const int N = 1000;
+    Graph<int,int,long> g(true);
+    mt19937 rng(29);
+    vector<long> p(N);
+    for (int i=0;i<N;++i) { g.add_node(i, 0); p[i] = rng() % 60; }
+    for (int u=0;u<N;++u) {
+        for (int k=0;k<20;++k) {
+            int v = rng() % N;
+            if (v == u || !g.find_edge_props(u, v).empty()) continue;
+            g.add_edge(u, v, (long)(rng() % 40) + p[u] - p[v]);
+        }
+    }
+    auto identity = [](const long &w)->long { return w; };
+
+    auto t0 = chrono::steady_clock::now();
+    auto [d0, p0, neg0] = bellman_ford(g, 0, identity);
+    auto t1 = chrono::steady_clock::now();
+    auto csr = make_csr(g, identity);
+    auto ms = [](auto a, auto b) { return chrono::duration<double, milli>(b - a).count(); };
+    cout << "bellman_ford          : " << ms(t0, t1) << " ms\n";
+
+    for (size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        auto t2 = chrono::steady_clock::now();
+        auto [dist, prev, negative] = bellman_ford_parallel_dense(csr, csr.index.at(0), pool);
+        auto t3 = chrono::steady_clock::now();
+        bool same = negative == neg0;
+        for (size_t i=0;i<csr.node_count();++i) same = same && dist[i] == d0[csr.ids[i]];
+        cout << "bellman_ford_parallel x" << threads << ": " << ms(t2, t3) << " ms"
+             << (same ? "" : " MISMATCH") << "\n";
+    }
+    cout << "\n";
+}
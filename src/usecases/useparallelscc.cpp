@@ -0,0 +1,46 @@
+#include "usecases/graphs/useparallelscc.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_parallel_scc() {
+    cout << "*** use_parallel_scc() ***\n";
+
+    // dependency-graph shape: a giant tangled core, tree-like tails that trimming
+    // peels off, and a few thousand small cycles hanging off the core
+    const int CORE = 150000, TAIL = 100000, SMALL = 3000;
+    mt19937 rng(44);
+    Graph<string,int,int> g(true);
+    for (int i=0;i<CORE;++i) g.add_edge(i, (i + 1) % CORE);
+    for (int i=0;i<CORE;++i) g.add_edge((int)(rng() % CORE), (int)(rng() % CORE));
+    for (int i=0;i<TAIL;++i) g.add_edge(CORE + i, (int)(rng() % (CORE + i)));
+    for (int i=0;i<SMALL;++i) {
+        int a = CORE + TAIL + 2 * i;
+        g.add_edge(a, a + 1); g.add_edge(a + 1, a);
+        g.add_edge((int)(rng() % CORE), a);
+    }
+    auto csr = make_csr_topology(g);
+
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    auto t0 = chrono::steady_clock::now();
+    auto k = kosaraju_scc_dense(csr);
+    auto t1 = chrono::steady_clock::now();
+    cout << "kosaraju_scc_dense    : " << k.count << " components, " << ms(t0, t1) << " ms\n";
+    for (size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        auto s = chrono::steady_clock::now();
+        auto p = parallel_scc_dense(csr, pool);
+        auto e = chrono::steady_clock::now();
+        cout << "parallel_scc_dense x" << threads << ": " << p.count << " components, " << ms(s, e) << " ms"
+             << (p.count == k.count ? "" : " MISMATCH") << "\n";
+    }
+    cout << "\n";
+}
@@ -0,0 +1,61 @@
+#include "usecases/graphs/userestricted.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_restricted_intermediate_queries() {
+    cout << "*** use_restricted_intermediate_queries() ***\n";
+
+    // stops 1..5; a query (o, d, t) may only pass through stops 1..t
+    Graph<int,int,int> net(true);
+    net.add_edge(1, 2, 10);
+    net.add_edge(2, 3, 10);
+    net.add_edge(1, 4, 2);
+    net.add_edge(4, 3, 2);
+    net.add_edge(3, 5, 1);
+    net.add_edge(1, 5, 30);
+    auto identity = [](const int &w)->int { return w; };
+    vector<int> order = {1, 2, 3, 4, 5};
+
+    vector<RestrictedQuery<int>> queries = {
+        {1, 5, 0}, {1, 5, 2}, {1, 5, 3}, {1, 5, 4}, {1, 3, 3}, {5, 1, 5},
+    };
+    auto answers = restricted_intermediate_queries(net, identity, order, queries, true, 2);
+    for (size_t q=0;q<queries.size();++q) {
+        cout << queries[q].source << " -> " << queries[q].target << " via <= " << queries[q].allowed << ": ";
+        if (!answers[q].reachable()) { cout << "-1\n"; continue; }
+        cout << answers[q].distance << " (";
+        for (size_t i=0;i<answers[q].path.size();++i) cout << (i ? " " : "") << answers[q].path[i];
+        cout << ")\n";
+    }
+
+    // 400 stops, 20000 queries: one matrix instead of one per t
+    const int N = 400;
+    Graph<int,int,long> big(true);
+    mt19937 rng(43);
+    for (int i=1;i<=N;++i) big.add_node(i, 0);
+    for (int k=0;k<8*N;++k) big.add_edge(1 + rng() % N, 1 + rng() % N, 1 + rng() % 100);
+    vector<int> stops;
+    for (int i=1;i<=N;++i) stops.push_back(i);
+    vector<RestrictedQuery<int>> many;
+    for (int q=0;q<20000;++q) many.push_back({1 + (int)(rng() % N), 1 + (int)(rng() % N), rng() % (N + 1)});
+    auto w = [](const long &x)->long { return x; };
+
+    auto t0 = chrono::steady_clock::now();
+    auto res = restricted_intermediate_queries(big, w, stops, many, false);
+    auto t1 = chrono::steady_clock::now();
+    size_t reachable = 0;
+    for (const auto &r : res) reachable += r.reachable();
+    cout << many.size() << " queries on " << N << " stops: " << reachable << " reachable, "
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms, matrix "
+         << N * N * sizeof(long) / 1024 << " KiB (per-t snapshots: "
+         << (size_t)(N + 1) * N * N * sizeof(long) / (1024 * 1024) << " MiB)\n\n";
+}
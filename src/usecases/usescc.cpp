@@ -0,0 +1,47 @@
+#include "usecases/graphs/usescc.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_iterative_scc() {
+    cout << "*** use_iterative_scc() ***\n";
+
+    // 1 -> 2 -> 3 -> 1 feeds 4 <-> 5, and 6 hangs off 5
+    Graph<string,int,int> g(true);
+    g.add_edge(1, 2); g.add_edge(2, 3); g.add_edge(3, 1);
+    g.add_edge(3, 4); g.add_edge(4, 5); g.add_edge(5, 4);
+    g.add_edge(5, 6);
+    auto show = [](const auto &comps) {
+        for (const auto &c : comps) {
+            cout << " {";
+            for (auto id : c) cout << " " << id;
+            cout << " }";
+        }
+        cout << "\n";
+    };
+    cout << "kosaraju (sources first):"; show(kosaraju_scc(g));
+    cout << "tarjan   (sinks first)  :"; show(tarjan_scc(g));
+
+    // one 1000000-node cycle: the old recursive DFS overflowed the stack here
+    const int N = 1000000;
+    Graph<string,int,int> ring(true);
+    for (int i=0;i<N;++i) ring.add_edge(i, (i + 1) % N);
+    auto csr = make_csr_topology(ring);
+
+    auto t0 = chrono::steady_clock::now();
+    auto k = kosaraju_scc_dense(csr);
+    auto t1 = chrono::steady_clock::now();
+    auto t = tarjan_scc_dense(csr);
+    auto t2 = chrono::steady_clock::now();
+
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << N << "-node ring, kosaraju_scc_dense: " << k.count << " component(s) in " << ms(t0, t1) << " ms\n";
+    cout << N << "-node ring, tarjan_scc_dense  : " << t.count << " component(s) in " << ms(t1, t2) << " ms\n\n";
+}
@@ -0,0 +1,53 @@
+#include "usecases/graphs/useshortestpathtree.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_shortest_path_tree() {
+    cout << "*** use_shortest_path_tree() ***\n";
+
+    Graph<string,string,double> roads(true);
+    roads.add_edge("A", "B", 4.0);
+    roads.add_edge("A", "C", 1.5);
+    roads.add_edge("C", "B", 2.0);
+    roads.add_edge("B", "D", 1.0);
+    roads.add_node("E", "isolated");
+    auto km = [](const double &w)->double { return w; };
+
+    auto tree = dijkstra_tree(roads, string("A"), km);
+    for (const auto &[id, d] : tree) cout << id << "=" << d << " ";
+    cout << "\nA -> D: " << tree["D"] << " via";
+    for (const auto &id : reconstruct_path(tree, string("D"))) cout << " " << id;
+    cout << "\nE reached? " << (tree.path_to("E").empty() ? "NO" : "YES") << "\n";
+
+    // 200000 nodes: the same search returning maps vs a tree
+    const int N = 200000;
+    mt19937 rng(42);
+    Graph<int,int,int> g(true);
+    for (int i=0;i<N;++i) g.add_node(i, i);
+    for (int i=0;i<N;++i)
+        for (int k=0;k<3;++k) g.add_edge(i, (int)(rng() % N), 1 + (int)(rng() % 100));
+    auto w = [](const int &x)->int { return x; };
+
+    auto t0 = chrono::steady_clock::now();
+    auto [dist, prev] = dijkstra(g, 0, w);
+    auto t1 = chrono::steady_clock::now();
+    auto t = dijkstra_tree(g, 0, w);
+    auto t2 = chrono::steady_clock::now();
+
+    bool same = true;
+    for (const auto &[id, d] : t) same = same && dist[id] == d;
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << N << " nodes, dijkstra (maps)   : " << ms(t0, t1) << " ms\n";
+    cout << N << " nodes, dijkstra_tree     : " << ms(t1, t2) << " ms, dist+prev "
+         << (t.size() * (sizeof(int) + sizeof(size_t))) / 1024 << " KiB"
+         << (same ? "" : " MISMATCH") << "\n\n";
+}
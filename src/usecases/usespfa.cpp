@@ -0,0 +1,57 @@
+#include "usecases/graphs/usespfa.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_spfa_and_yen() {
+    cout << "*** use_spfa_and_yen() ***\n";
+
+    // sparse random DAG-ish graph: arcs mostly go forward, a few negative arcs
+    const int N = 3000;
+    Graph<int,int,long> g(true);
+    mt19937 rng(17);
+    for (int i=0;i<N;++i) g.add_node(i, 0);
+    for (int u=0;u<N;++u) {
+        for (int k=0;k<3;++k) {
+            int v = (u + 1 + rng() % 50) % N;
+            if (v == u || !g.find_edge_props(u, v).empty()) continue;
+            long w = 1 + rng() % 100;
+            if (rng() % 50 == 0) w = -w / 4;  // a few negative arcs
+            g.add_edge(u, v, w);
+        }
+    }
+    auto identity = [](const long &w)->long { return w; };
+
+    auto t0 = chrono::steady_clock::now();
+    auto [d0, p0, neg0] = bellman_ford(g, 0, identity);
+    auto t1 = chrono::steady_clock::now();
+    auto [d1, p1, neg1] = spfa(g, 0, identity);
+    auto t2 = chrono::steady_clock::now();
+    auto [d2, p2, neg2] = bellman_ford_yen(g, 0, identity);
+    auto t3 = chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return chrono::duration<double, milli>(b - a).count(); };
+    cout << "bellman_ford    : " << ms(t0, t1) << " ms, dist to " << N-1 << " = " << d0[N-1] << "\n";
+    cout << "spfa            : " << ms(t1, t2) << " ms, dist to " << N-1 << " = " << d1[N-1]
+         << (d0 == d1 && neg0 == neg1 ? "" : " MISMATCH") << "\n";
+    cout << "bellman_ford_yen: " << ms(t2, t3) << " ms, dist to " << N-1 << " = " << d2[N-1]
+         << (d0 == d2 && neg0 == neg2 ? "" : " MISMATCH") << "\n";
+
+    // 1 -> 2 -> 3 -> 1 has weight -1
+    Graph<int,int,int> cyc(true);
+    cyc.add_edge(0, 1, 2);
+    cyc.add_edge(1, 2, 1);
+    cyc.add_edge(2, 3, -3);
+    cyc.add_edge(3, 1, 1);
+    auto id_int = [](const int &w)->int { return w; };
+    cout << "cycle graph: spfa negative? " << (get<2>(spfa(cyc, 0, id_int)) ? "YES" : "NO")
+         << ", yen negative? " << (get<2>(bellman_ford_yen(cyc, 0, id_int)) ? "YES" : "NO") << "\n\n";
+}
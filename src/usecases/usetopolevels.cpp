@@ -0,0 +1,53 @@
+#include "usecases/graphs/usetopolevels.hpp"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_topological_levels() {
+    cout << "*** use_topological_levels() ***\n";
+
+    // build graph: target -> target that depends on it; value = job time in ms
+    Graph<int,string,int> build(true);
+    unordered_map<string,int> cost = {
+        {"proto", 40}, {"libcore", 10}, {"libnet", 40}, {"libui", 10},
+        {"server", 10}, {"client", 40}, {"tests", 80}, {"bundle", 10}
+    };
+    for (const auto &[name, ms] : cost) build.add_node(name, ms);
+    build.add_edge("proto", "libnet"); build.add_edge("libcore", "libnet");
+    build.add_edge("libcore", "libui");
+    build.add_edge("libnet", "server"); build.add_edge("libnet", "client");
+    build.add_edge("libui", "client"); build.add_edge("libui", "tests");
+    build.add_edge("server", "bundle"); build.add_edge("client", "bundle");
+
+    auto levels = topological_levels(build, 4);
+    for (size_t l = 0; l < levels.size(); ++l) {
+        cout << "level " << l << ":";
+        for (const auto &id : levels[l]) cout << " " << id;
+        cout << "\n";
+    }
+
+    // run the jobs (sleeps) on 4 workers: barrier after every level vs streaming
+    auto run_job = [&](const string &id) { this_thread::sleep_for(chrono::milliseconds(cost[id])); };
+    ThreadPool pool(4);
+    auto t0 = chrono::steady_clock::now();
+    for (const auto &level : levels)
+        pool.parallel_for(level.size(), [&](size_t b, size_t e, size_t) {
+            for (size_t i = b; i < e; ++i) run_job(level[i]);
+        }, 1);
+    auto t1 = chrono::steady_clock::now();
+    topological_stream(build, [&](const string &id, size_t) { run_job(id); }, 4);
+    auto t2 = chrono::steady_clock::now();
+
+    auto ms = [](auto x, auto y) { return chrono::duration<double, milli>(y - x).count(); };
+    cout << "level barriers: " << ms(t0, t1) << " ms\n";
+    cout << "streaming     : " << ms(t1, t2) << " ms\n\n";
+}
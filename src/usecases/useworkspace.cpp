@@ -0,0 +1,65 @@
+#include "usecases/graphs/useworkspace.hpp"
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include "graph.hpp"
+#include "graph_algorithms.hpp"
+#include "node.hpp"
+
+using namespace std;
+using namespace graph_algo;
+
+void use_sssp_workspaces() {
+    cout << "*** use_sssp_workspaces() ***\n";
+
+    // 100x100 grid, many short point-to-point queries
+    const int W = 100;
+    Graph<int,int,double> grid(false);
+    for (int r=0;r<W;++r) {
+        for (int c=0;c<W;++c) {
+            int id = r*W + c;
+            if (r+1 < W) grid.add_edge(id, id+W, 1.0 + (id % 7));
+            if (c+1 < W) grid.add_edge(id, id+1, 1.0 + (id % 5));
+        }
+    }
+    auto identity = [](const double &w)->double { return w; };
+    auto csr = make_csr(grid, identity);
+
+    mt19937 rng(7);
+    uniform_int_distribution<int> pick(0, W*W - 1);
+    vector<pair<int,int>> queries;
+    for (int i=0;i<200;++i) {
+        int s = pick(rng);
+        queries.push_back({s, min(W*W - 1, s + 3*W + 3)}); // nearby targets
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    double fresh = 0;
+    for (auto [s, t] : queries) fresh += dijkstra_with_extractor<Graph<int,int,double>, double>(grid, s, identity).first[t];
+    auto t1 = chrono::steady_clock::now();
+
+    DijkstraWorkspace<int,double> ws(csr);
+    double reused = 0;
+    size_t touched = 0;
+    for (auto [s, t] : queries) {
+        reused += ws.run(s, t).distance;
+        touched += ws.touched().size();
+    }
+    auto t2 = chrono::steady_clock::now();
+
+    cout << "200 queries, fresh dijkstra maps : " << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    cout << "200 queries, DijkstraWorkspace   : " << chrono::duration<double, milli>(t2 - t1).count() << " ms"
+         << " (avg touched " << touched / queries.size() << " of " << csr.node_count() << ")"
+         << (fresh == reused ? "" : " MISMATCH") << "\n";
+
+    BfsWorkspace<int,double> bws(csr);
+    bws.run(0);
+    cout << "BFS hops 0 -> " << W*W - 1 << ": " << bws.distance(W*W - 1) << "\n";
+
+    BellmanFordWorkspace<int,double> bfw(csr);
+    bool negative = bfw.run(0);
+    cout << "Bellman-Ford from 0: negative cycle? " << (negative ? "YES" : "NO")
+         << ", dist to " << W*W - 1 << " = " << bfw.distance(W*W - 1) << "\n\n";
+}